@@ -0,0 +1,228 @@
+/*
+ * Compares the icon codecs the firmware can decode on a corpus of icons.
+ *
+ *   .pio/build/codec/program [icon.rgb565...]
+ *
+ * Corpus files are 128x128 little endian RGB565 icons as the computer sends them, tools/icon_corpus.py makes
+ * them from PNGs. Without arguments it runs on the real application icons in icons/corpus (run from the
+ * PlatformIO directory, as pio does). A few built-in icons are always included. For each icon it reports the compressed size, the
+ * number of ICON_PACKETs and the time the firmware's streaming decoder needs for the whole icon, fed one packet
+ * at a time. Times are for the host CPU, compare the codecs with each other rather than against the Teensy.
+ *
+ * A second table gives host cycles per decompressed byte of the portable fastlz_decompress() and the firmware's
+ * FastLZStream, the same measurement the board prints for its icons when sent 'd' over the serial port.
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <filesystem>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "DecodeBenchmark.h"
+#include "FastLZStream.h"
+#include "Globals.h"
+#include "IconRLE.h"
+#include "MemoryArena.h"
+#include "icons.h"
+#include "packets/PacketPositions.h"
+#include "thirdparty/fastlz.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t ICON_PIXELS = ICON_SIZE * ICON_SIZE;
+    constexpr uint32_t ICON_BYTES = ICON_PIXELS * sizeof(uint16_t);
+    constexpr uint8_t PAYLOAD = PacketPositions::IconPacket::NUM_ICON_BYTES_SENT;
+    constexpr uint32_t RUNS = 200;
+    constexpr const char *DEFAULT_CORPUS = "icons/corpus";
+
+    struct Icon {
+        std::string name;
+        std::vector<uint16_t> pixels;
+    };
+
+    struct Result {
+        uint32_t bytes = 0;
+        uint32_t packets = 0;
+        double decodeMicros = 0;
+        bool roundTrip = false;
+    };
+
+    uint16_t rgb565(const float r, const float g, const float b) {
+        return static_cast<uint16_t>(lroundf(r * 31) << 11 | lroundf(g * 63) << 5 | lroundf(b * 31));
+    }
+
+    // coverage of a rounded square and a ring, 4x4 supersampled for anti-aliased edges like a real icon
+    Icon flatBadge() {
+        Icon icon{"badge (built-in)", std::vector<uint16_t>(ICON_PIXELS)};
+        for (uint32_t y = 0; y < ICON_SIZE; y++) {
+            for (uint32_t x = 0; x < ICON_SIZE; x++) {
+                float square = 0, ring = 0;
+                for (uint8_t sample = 0; sample < 16; sample++) {
+                    const float sx = x + (sample % 4 + 0.5f) / 4 - 64;
+                    const float sy = y + (sample / 4 + 0.5f) / 4 - 64;
+                    const float dx = fmaxf(fabsf(sx) - 40, 0);
+                    const float dy = fmaxf(fabsf(sy) - 40, 0);
+                    square += dx * dx + dy * dy < 16 * 16;
+                    const float radius = sqrtf(sx * sx + sy * sy);
+                    ring += radius > 22 && radius < 34;
+                }
+                square /= 16;
+                ring /= 16;
+                icon.pixels[y * ICON_SIZE + x] = rgb565(square * (0.9f + 0.1f * ring), square * (0.3f + 0.7f * ring),
+                                                        square * (0.2f + 0.8f * ring));
+            }
+        }
+        return icon;
+    }
+
+    std::vector<Icon> corpus(const int argc, char **argv) {
+        std::vector<Icon> icons;
+        Icon builtin{"default icon (built-in)", std::vector<uint16_t>(ICON_PIXELS)};
+        IconRLE::decompress(defaultIcon.rle, defaultIcon.length, builtin.pixels.data());
+        icons.push_back(builtin);
+        icons.push_back(flatBadge());
+        Icon gradient{"gradient (built-in)", std::vector<uint16_t>(ICON_PIXELS)};
+        for (uint32_t i = 0; i < ICON_PIXELS; i++) {
+            gradient.pixels[i] = rgb565(i % ICON_SIZE / 127.0f, i / ICON_SIZE / 127.0f, 0.5f);
+        }
+        icons.push_back(gradient);
+
+        std::vector<std::string> paths(argv + 1, argv + argc);
+        if (paths.empty()) {
+            std::error_code error;
+            for (const auto &entry: std::filesystem::directory_iterator(DEFAULT_CORPUS, error)) {
+                if (entry.path().extension() == ".rgb565") {
+                    paths.push_back(entry.path().string());
+                }
+            }
+            if (error) {
+                printf("cannot read %s, only the built-in icons are compared\n", DEFAULT_CORPUS);
+            }
+            std::sort(paths.begin(), paths.end());
+        }
+        for (const auto &path: paths) {
+            Icon icon{path, std::vector<uint16_t>(ICON_PIXELS)};
+            FILE *file = fopen(path.c_str(), "rb");
+            const size_t read = file == nullptr ? 0 : fread(icon.pixels.data(), 1, ICON_BYTES, file);
+            if (file != nullptr) {
+                fclose(file);
+            }
+            if (read != ICON_BYTES) {
+                printf("skipping %s, not a %" PRIu32 " byte icon\n", path.c_str(), ICON_BYTES);
+                continue;
+            }
+            const size_t slash = icon.name.find_last_of('/');
+            if (slash != std::string::npos) {
+                icon.name = icon.name.substr(slash + 1);
+            }
+            icons.push_back(icon);
+        }
+        return icons;
+    }
+
+    // the last packet is padded to a full payload like on the wire
+    std::vector<uint8_t> padToPackets(const std::vector<uint8_t> &compressed) {
+        std::vector<uint8_t> padded((compressed.size() + PAYLOAD - 1) / PAYLOAD * PAYLOAD);
+        memcpy(padded.data(), compressed.data(), compressed.size());
+        return padded;
+    }
+
+    template<typename Decoder, typename Begin>
+    Result measure(const std::vector<uint8_t> &compressed, const Icon &icon, Begin begin) {
+        Result result;
+        result.bytes = compressed.size();
+        result.packets = (result.bytes + PAYLOAD - 1) / PAYLOAD;
+        const std::vector<uint8_t> padded = padToPackets(compressed);
+        std::vector<uint16_t> decoded(ICON_PIXELS);
+        const auto start = Clock::now();
+        for (uint32_t run = 0; run < RUNS; run++) {
+            Decoder decoder;
+            begin(decoder, decoded.data(), result.bytes);
+            for (uint32_t packet = 0; packet < result.packets; packet++) {
+                decoder.feed(&padded[packet * PAYLOAD], PAYLOAD);
+            }
+            result.roundTrip = decoder.getStatus() == Decoder::Status::DONE && decoded == icon.pixels;
+        }
+        result.decodeMicros = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / RUNS;
+        return result;
+    }
+
+    Result measureFastLZ(const Icon &icon) {
+        std::vector<uint8_t> compressed(ICON_BYTES * 21 / 20 + 66);
+        compressed.resize(fastlz_compress_level(1, icon.pixels.data(), ICON_BYTES, compressed.data()));
+        return measure<FastLZStream>(compressed, icon, [](FastLZStream &decoder, uint16_t *output, uint32_t size) {
+            decoder.begin(reinterpret_cast<uint8_t *>(output), ICON_BYTES, size);
+        });
+    }
+
+    Result measureRLE(const Icon &icon) {
+        std::vector<uint8_t> compressed(IconRLE::MAX_COMPRESSED);
+        compressed.resize(IconRLE::compress(icon.pixels.data(), compressed.data()));
+        return measure<IconRLEStream>(compressed, icon, [](IconRLEStream &decoder, uint16_t *output,
+                                                           uint32_t size) {
+            decoder.begin(output, size);
+        });
+    }
+
+    // time stamp counter where there is one, otherwise nanoseconds stand in for cycles
+    uint32_t hostCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+        return static_cast<uint32_t>(__rdtsc());
+#else
+        return static_cast<uint32_t>(Clock::now().time_since_epoch().count());
+#endif
+    }
+
+    class StdoutPrint final : public Print {
+    public:
+        size_t write(const uint8_t value) override {
+            return fwrite(&value, 1, 1, stdout);
+        }
+    };
+
+    void printRow(const char *name, const Result &fastlz, const Result &rle) {
+        printf("%-28.28s %7" PRIu32 " %5" PRIu32 " %8.2f   %7" PRIu32 " %5" PRIu32 " %8.2f %7.1f%%%s\n", name,
+               fastlz.bytes, fastlz.packets, fastlz.decodeMicros, rle.bytes, rle.packets, rle.decodeMicros,
+               100.0 * rle.bytes / fastlz.bytes, fastlz.roundTrip && rle.roundTrip ? "" : "  MISMATCH");
+    }
+}
+
+int main(const int argc, char **argv) {
+    const std::vector<Icon> icons = corpus(argc, argv);
+    printf("%-28s %-24s   %-24s %8s\n", "", "fastlz level 1", "IconRLE", "size");
+    printf("%-28s %7s %5s %8s   %7s %5s %8s\n", "icon", "bytes", "pkts", "us", "bytes", "pkts", "us");
+    Result fastlzTotal, rleTotal;
+    fastlzTotal.roundTrip = rleTotal.roundTrip = true;
+    for (const auto &icon: icons) {
+        const Result fastlz = measureFastLZ(icon);
+        const Result rle = measureRLE(icon);
+        printRow(icon.name.c_str(), fastlz, rle);
+        for (auto [total, result]: {std::pair{&fastlzTotal, &fastlz}, std::pair{&rleTotal, &rle}}) {
+            total->bytes += result->bytes;
+            total->packets += result->packets;
+            total->decodeMicros += result->decodeMicros;
+            total->roundTrip &= result->roundTrip;
+        }
+    }
+    printRow("total", fastlzTotal, rleTotal);
+
+    printf("\nFastLZ level 1 decode, host cycles per decompressed byte\n");
+    StdoutPrint out;
+    static uint8_t scratchMemory[128 * 1024];
+    MemoryArena scratch("scratch");
+    scratch.begin(scratchMemory, sizeof(scratchMemory));
+    bool identical = true;
+    for (const auto &icon: icons) {
+        const DecodeCycles cycles = measureFastLZDecode(icon.pixels.data(), hostCycles, RUNS, &scratch);
+        printDecodeCycles(out, icon.name.c_str(), cycles);
+        identical &= cycles.identical;
+    }
+    return fastlzTotal.roundTrip && rleTotal.roundTrip && identical ? 0 : 1;
+}
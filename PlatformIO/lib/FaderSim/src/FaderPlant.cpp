@@ -0,0 +1,72 @@
+#include "FaderPlant.h"
+#include <algorithm>
+#include <cmath>
+
+
+FaderPlant::FaderPlant(const Parameters &_parameters, const float _position) {
+    parameters = _parameters;
+    position = _position;
+}
+
+void FaderPlant::step(const float drive, const float dt) {
+    const float scale = parameters.stallAcceleration;
+    float force = scale * (std::clamp(drive, -1.0f, 1.0f) - velocity / parameters.noLoadSpeed);
+    if (touched) {
+        const float stiffness = scale / parameters.fingerGive;
+        force -= stiffness * (position - grabbedAt) + 2.0f * std::sqrt(stiffness) * velocity;
+    }
+
+    // stuck until the applied force beats the breakaway friction, then kinetic friction against the motion
+    if (std::fabs(velocity) < STANDSTILL) {
+        if (std::fabs(force) <= parameters.staticFriction * scale) {
+            velocity = 0;
+            return;
+        }
+        velocity += (force - std::copysign(parameters.kineticFriction * scale, force)) * dt;
+    } else {
+        const float before = velocity;
+        velocity += (force - std::copysign(parameters.kineticFriction * scale, velocity)) * dt;
+        // friction can stop the carriage but never push it back
+        if ((velocity > 0) != (before > 0)) {
+            velocity = 0;
+        }
+    }
+    position += velocity * dt;
+
+    if (position <= parameters.endStopLow || position >= parameters.endStopHigh) {
+        position = std::clamp(position, parameters.endStopLow, parameters.endStopHigh);
+        velocity = 0;
+    }
+}
+
+void FaderPlant::setTouched(const bool _touched) {
+    if (_touched && !touched) {
+        grabbedAt = position;
+    }
+    touched = _touched;
+}
+
+bool FaderPlant::isTouched() const {
+    return touched;
+}
+
+const FaderPlant::Parameters &FaderPlant::getParameters() const {
+    return parameters;
+}
+
+float FaderPlant::getPosition() const {
+    return position;
+}
+
+float FaderPlant::getVelocity() const {
+    return velocity;
+}
+
+uint16_t FaderPlant::readAdc(std::mt19937 &random) const {
+    std::normal_distribution<float> noise(0.0f, parameters.adcNoise);
+    return static_cast<uint16_t>(std::clamp(std::lround(position + noise(random)), 0L, 1023L));
+}
+
+uint32_t FaderPlant::getChargeMicros() const {
+    return static_cast<uint32_t>(std::lround(parameters.electrodeMicros + (touched ? parameters.fingerMicros : 0)));
+}
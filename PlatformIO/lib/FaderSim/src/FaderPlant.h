@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+/**
+ * @brief Mechanical and electrical model of one motorized fader
+ *
+ * The carriage is a mass driven by a DC motor (drive force falls off with speed through the back EMF), held
+ * back by Coulomb friction with a higher breakaway level, and stopped hard at both ends of its travel. A
+ * finger on the cap is a stiff spring and damper around the point where it grabbed the cap, and adds to the
+ * capacitance the touch sensor sees.
+ *
+ * Everything is in raw pot counts: position in counts, speed in counts per second, forces as the acceleration
+ * they cause. The pot reading adds gaussian noise and quantizes to the 10 bit ADC.
+ */
+class FaderPlant {
+public:
+    struct Parameters {
+        /// Acceleration of a stalled carriage at full drive (counts/s^2)
+        float stallAcceleration = 250000.0f;
+        /// Steady speed at full drive with no load (counts/s)
+        float noLoadSpeed = 5000.0f;
+        /// Drive fraction needed to break the carriage loose
+        float staticFriction = 0.18f;
+        /// Drive fraction lost to friction while moving
+        float kineticFriction = 0.14f;
+        float endStopLow = 40.0f;
+        float endStopHigh = 985.0f;
+        /// Pot noise, standard deviation in counts
+        float adcNoise = 0.7f;
+        /// Finger stiffness, full drive pushes the cap this many counts away from where it was grabbed
+        float fingerGive = 20.0f;
+        /// Charge (and discharge) time of the touch electrode
+        float electrodeMicros = 3.0f;
+        float fingerMicros = 5.0f;
+    };
+
+    FaderPlant() = default;
+
+    FaderPlant(const Parameters &_parameters, float _position);
+
+    ~FaderPlant() = default;
+
+    /// Moves the model on by dt seconds with drive in [-1, 1], positive toward higher counts
+    void step(float drive, float dt);
+
+    void setTouched(bool _touched);
+
+    [[nodiscard]] bool isTouched() const;
+
+    [[nodiscard]] const Parameters &getParameters() const;
+
+    [[nodiscard]] float getPosition() const;
+
+    [[nodiscard]] float getVelocity() const;
+
+    /// Noisy 10 bit pot reading
+    [[nodiscard]] uint16_t readAdc(std::mt19937 &random) const;
+
+    /// Time for the touch electrode to charge through the send resistor
+    [[nodiscard]] uint32_t getChargeMicros() const;
+
+private:
+    /// Speeds below this count as standing still for the friction model
+    static constexpr float STANDSTILL = 1.0f;
+
+    Parameters parameters;
+    float position = 500.0f;
+    float velocity = 0;
+    bool touched = false;
+    float grabbedAt = 0;
+};
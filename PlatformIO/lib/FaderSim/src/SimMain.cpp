@@ -0,0 +1,350 @@
+/*
+ * Runs the firmware against a physics model of the eight faders and scores the position control.
+ *
+ *   .pio/build/sim/program [kp=0.6] [ki=6] [kd=0.004] [vmax=4000] [amax=40000] [minout=18] [maxout=100]
+ *                          [tol=6] [sensitivity=1.5] [seed=1]
+ *
+ * Every scenario moves all faders at once, like a scene change from the computer, and reports the mean and
+ * worst channel. Settle time is measured from the new target to the last moment the fader was outside the
+ * controller tolerance; overshoot is how far it ran past the target; oscillations counts target crossings.
+ * Touch scenarios grab every fader mid-move and time how long the firmware keeps driving the motor.
+ */
+
+#include <Arduino.h>
+#include <cmath>
+#include <random>
+#include "FakeHardware.h"
+#include "FaderPlant.h"
+#include "Globals.h"
+#include "FaderChannel.h"
+#include "FaderServo.h"
+#include "MuxManager.h"
+
+void setup();
+
+void loop();
+
+extern FaderChannel faderChannels[CHANNELS];
+extern FaderServo faderServo;
+
+namespace {
+    constexpr uint32_t PHYSICS_STEP_MICROS = 50;
+    constexpr float PHYSICS_STEP_SECONDS = PHYSICS_STEP_MICROS / 1000000.0f;
+    /// Simulated time between two loop() passes
+    constexpr uint32_t LOOP_STEP_MICROS = 20;
+    constexpr uint32_t SCENARIO_MICROS = 800000;
+    /// Untimed settling before each scenario and after a touch is released
+    constexpr uint32_t PREPARE_MICROS = 600000;
+    /// Spread of the mechanical parameters between channels
+    constexpr float CHANNEL_SPREAD = 0.1f;
+    /// Hysteresis around the target before a crossing counts
+    constexpr float CROSSING_BAND = 1.0f;
+
+    struct Scenario {
+        const char *name;
+        uint8_t from;
+        uint8_t to;
+        /// Grab the fader this long after the move starts, 0 for no touch
+        uint32_t touchAfterMicros;
+    };
+
+    constexpr Scenario SCENARIOS[] = {
+        {"step 50 -> 55", 50, 55, 0},
+        {"step 55 -> 45", 55, 45, 0},
+        {"step 20 -> 80", 20, 80, 0},
+        {"step 80 -> 20", 80, 20, 0},
+        {"step 10 -> 100", 10, 100, 0},
+        {"step 100 -> 10", 100, 10, 0},
+        {"touch 10 -> 90", 10, 90, 40000},
+        {"touch 90 -> 10", 90, 10, 40000},
+    };
+
+    struct ChannelResult {
+        uint64_t startCycles = 0;
+        float target = 0;
+        float direction = 1;
+        int8_t side = -1;
+        uint64_t lastOutsideCycles = 0;
+        float overshoot = 0;
+        uint32_t oscillations = 0;
+        uint64_t touchCycles = 0;
+        uint64_t stopCycles = 0;
+        float drag = 0;
+    };
+
+    FaderPlant plants[CHANNELS];
+    std::mt19937 randomSource;
+    uint32_t touchGeneration = 0;
+    ChannelResult results[CHANNELS];
+    bool recording = false;
+    float tolerance = 6;
+
+    float cyclesToMillis(const uint64_t cycles) {
+        return cycles / (fake::CYCLES_PER_MICRO * 1000.0f);
+    }
+
+    float getDrive(const uint8_t channel) {
+        const FaderMotor *motor = faderChannels[channel].motor;
+        return (fake::getAnalogWrite(motor->getForwardPin()) - fake::getAnalogWrite(motor->getBackwardPin())) / 255.0f;
+    }
+
+    // same mapping as FaderServo::targetToRaw
+    float targetToRaw(const uint8_t channel, const uint8_t volume) {
+        const ChannelCalibration calibration = faderChannels[channel].getCalibration();
+        const float low = calibration.positionMin + 10;
+        const float high = calibration.positionMax - 10;
+        return low + (100 - volume) * (high - low) / 100.0f;
+    }
+
+    void record(const uint8_t channel, const float drive) {
+        ChannelResult &result = results[channel];
+        const uint64_t now = fake::nowCycles();
+        const float error = (plants[channel].getPosition() - result.target) * result.direction;
+        if (fabsf(error) > tolerance) {
+            result.lastOutsideCycles = now;
+        }
+        result.overshoot = max(result.overshoot, error);
+        if ((result.side < 0 && error > CROSSING_BAND) || (result.side > 0 && error < -CROSSING_BAND)) {
+            result.side = static_cast<int8_t>(-result.side);
+            result.oscillations++;
+        }
+        if (result.touchCycles != 0) {
+            if (result.stopCycles == 0 && drive == 0) {
+                result.stopCycles = now;
+            }
+            result.drag = max(result.drag, fabsf(plants[channel].getPosition() - result.target));
+        }
+    }
+
+    void physicsStep() {
+        for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+            const float drive = getDrive(channel);
+            plants[channel].step(drive, PHYSICS_STEP_SECONDS);
+            if (recording) {
+                record(channel, drive);
+            }
+        }
+        fake::schedule(PHYSICS_STEP_MICROS, physicsStep);
+    }
+
+    // the receive pin follows the send pin after the RC delay of whichever electrode the touch mux selects
+    void onPinWrite(const uint8_t pin, const uint8_t level) {
+        if (pin != TOUCH_SEND && pin != TOUCH_RECEIVE) {
+            return;
+        }
+        // driving either pin cancels a transition still in flight
+        const uint32_t generation = ++touchGeneration;
+        if (pin == TOUCH_SEND) {
+            const FaderPlant &plant = plants[muxManager.getChannel(MuxManager::TOUCH)];
+            fake::schedule(plant.getChargeMicros(), [generation, level] {
+                if (generation == touchGeneration) {
+                    fake::setPinInput(TOUCH_RECEIVE, level);
+                }
+            });
+        }
+    }
+
+    void installPlants(const uint32_t seed) {
+        randomSource.seed(seed);
+        std::uniform_real_distribution<float> spread(1.0f - CHANNEL_SPREAD, 1.0f + CHANNEL_SPREAD);
+        std::uniform_real_distribution<float> start(200.0f, 800.0f);
+        for (auto &plant: plants) {
+            FaderPlant::Parameters parameters;
+            parameters.stallAcceleration *= spread(randomSource);
+            parameters.noLoadSpeed *= spread(randomSource);
+            parameters.staticFriction *= spread(randomSource);
+            parameters.kineticFriction = min(parameters.kineticFriction * spread(randomSource),
+                                             parameters.staticFriction);
+            parameters.endStopLow += (spread(randomSource) - 1.0f) * 100.0f;
+            parameters.endStopHigh += (spread(randomSource) - 1.0f) * 100.0f;
+            plant = FaderPlant(parameters, start(randomSource));
+        }
+        fake::setAdcSource([](uint8_t) {
+            return plants[muxManager.getChannel(MuxManager::POT)].readAdc(randomSource);
+        });
+        fake::onPinWrite(onPinWrite);
+        fake::schedule(PHYSICS_STEP_MICROS, physicsStep);
+    }
+
+    void runFor(const uint32_t micros) {
+        const uint64_t end = fake::nowCycles() + static_cast<uint64_t>(micros) * fake::CYCLES_PER_MICRO;
+        while (fake::nowCycles() < end) {
+            loop();
+            fake::advanceMicros(LOOP_STEP_MICROS);
+        }
+    }
+
+    void setTargets(const uint8_t volume) {
+        for (auto &channel: faderChannels) {
+            channel.setMaxVolume(volume);
+        }
+    }
+
+    void runScenario(const Scenario &scenario) {
+        setTargets(scenario.from);
+        runFor(PREPARE_MICROS);
+
+        for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+            ChannelResult &result = results[channel];
+            result = {};
+            result.startCycles = fake::nowCycles();
+            result.target = targetToRaw(channel, scenario.to);
+            result.direction = result.target >= plants[channel].getPosition() ? 1.0f : -1.0f;
+        }
+        recording = true;
+        setTargets(scenario.to);
+        if (scenario.touchAfterMicros == 0) {
+            runFor(SCENARIO_MICROS);
+        } else {
+            runFor(scenario.touchAfterMicros);
+            for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+                plants[channel].setTouched(true);
+                results[channel].touchCycles = fake::nowCycles();
+                results[channel].target = plants[channel].getPosition();
+            }
+            runFor(SCENARIO_MICROS - scenario.touchAfterMicros);
+        }
+        recording = false;
+
+        for (auto &plant: plants) {
+            plant.setTouched(false);
+        }
+    }
+
+    struct Summary {
+        float total = 0;
+        float worst = 0;
+        uint8_t count = 0;
+
+        void add(const float value) {
+            total += value;
+            worst = max(worst, value);
+            count++;
+        }
+
+        void print() const {
+            if (count == 0) {
+                printf("  %15s", "-");
+            } else {
+                printf("  %7.1f %7.1f", total / count, worst);
+            }
+        }
+    };
+
+    void printScenario(const Scenario &scenario) {
+        Summary settle;
+        Summary overshoot;
+        Summary oscillations;
+        Summary stop;
+        Summary drag;
+        uint8_t unsettled = 0;
+        for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+            const ChannelResult &result = results[channel];
+            if (scenario.touchAfterMicros == 0) {
+                if (fake::nowCycles() - result.lastOutsideCycles < PHYSICS_STEP_MICROS * fake::CYCLES_PER_MICRO * 2) {
+                    unsettled++;
+                } else {
+                    settle.add(cyclesToMillis(result.lastOutsideCycles - result.startCycles));
+                }
+                overshoot.add(result.overshoot);
+                oscillations.add(result.oscillations);
+            } else {
+                stop.add(result.stopCycles == 0 ? cyclesToMillis(fake::nowCycles() - result.touchCycles)
+                                                : cyclesToMillis(result.stopCycles - result.touchCycles));
+                drag.add(result.drag);
+            }
+        }
+        printf("%-16s", scenario.name);
+        settle.print();
+        overshoot.print();
+        oscillations.print();
+        stop.print();
+        drag.print();
+        if (unsettled > 0) {
+            printf("  %u unsettled", unsettled);
+        }
+        printf("\n");
+    }
+
+    bool parseArgument(const char *argument, FaderController::Gains &gains, float &sensitivity, uint32_t &seed) {
+        char key[16];
+        float value;
+        if (sscanf(argument, "%15[a-z]=%f", key, &value) != 2) {
+            return false;
+        }
+        const String name(key);
+        if (name == "kp") {
+            gains.kp = value;
+        } else if (name == "ki") {
+            gains.ki = value;
+        } else if (name == "kd") {
+            gains.kd = value;
+        } else if (name == "vmax") {
+            gains.maxVelocity = value;
+        } else if (name == "amax") {
+            gains.maxAcceleration = value;
+        } else if (name == "minout") {
+            gains.minOutput = static_cast<uint8_t>(value);
+        } else if (name == "maxout") {
+            gains.maxOutput = static_cast<uint8_t>(value);
+        } else if (name == "tol") {
+            gains.tolerance = static_cast<uint16_t>(value);
+        } else if (name == "sensitivity") {
+            sensitivity = value;
+        } else if (name == "seed") {
+            seed = static_cast<uint32_t>(value);
+        } else {
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(const int argc, char **argv) {
+    FaderController::Gains gains;
+    float sensitivity = 0;
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (!parseArgument(argv[i], gains, sensitivity, seed)) {
+            fprintf(stderr, "unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    installPlants(seed);
+    setup();
+    for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+        faderChannels[channel].setUnused(false);
+        faderServo.setGains(channel, gains);
+        if (sensitivity > 0) {
+            faderChannels[channel].setTouchSensitivity(sensitivity);
+        }
+        const ChannelCalibration calibration = faderChannels[channel].getCalibration();
+        const FaderPlant::Parameters &parameters = plants[channel].getParameters();
+        printf("channel %u: end stops %4.0f-%4.0f, calibrated %4u-%4u, touch baseline %lu\n", channel,
+               parameters.endStopLow, parameters.endStopHigh, calibration.positionMin, calibration.positionMax,
+               static_cast<unsigned long>(calibration.touchBaseline));
+    }
+    tolerance = gains.tolerance;
+
+    printf("\n%-16s  %15s  %15s  %15s  %15s  %15s\n", "", "settle ms", "overshoot", "oscillations",
+           "stop on touch ms", "drag counts");
+    printf("%-16s  %7s %7s  %7s %7s  %7s %7s  %7s %7s  %7s %7s\n", "scenario", "mean", "max", "mean", "max", "mean",
+           "max", "mean", "max", "mean", "max");
+    for (const Scenario &scenario: SCENARIOS) {
+        runScenario(scenario);
+        printScenario(scenario);
+        fake::sentRawHID().clear();
+    }
+
+    uint32_t overruns = 0;
+    uint32_t maxJitter = 0;
+    for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+        const FaderServo::ChannelStats stats = faderServo.getStats(channel);
+        overruns += stats.overruns;
+        maxJitter = max(maxJitter, stats.maxJitterMicros);
+    }
+    printf("\nservo: %lu overruns, max jitter %lu us\n", static_cast<unsigned long>(overruns),
+           static_cast<unsigned long>(maxJitter));
+    return 0;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// the firmware only includes this for the colour and font definitions ST7789_t3 already provides
+#include <Arduino.h>
@@ -0,0 +1,200 @@
+#pragma once
+
+/*
+ * Host build of the parts of the Teensy 4.1 core the firmware uses. Time is simulated (see FakeHardware.h):
+ * it only moves when the firmware waits (delay, yield) or the harness advances it, and every clock read costs
+ * a few cycles so busy-wait loops terminate. Peripheral registers are plain variables.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "WString.h"
+#include "Print.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define DMAMEM
+#define EXTMEM
+#define FASTRUN
+#define FLASHMEM
+#define PROGMEM
+
+#define F_CPU 600000000
+#define F_CPU_ACTUAL 600000000
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define RISING 2
+#define FALLING 3
+#define CHANGE 4
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+#define A8 22
+#define A9 23
+
+#define NUM_DIGITAL_PINS 55
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+template<typename A, typename B>
+constexpr auto min(const A &a, const B &b) -> decltype(a < b ? a : b) {
+    return b < a ? b : a;
+}
+
+template<typename A, typename B>
+constexpr auto max(const A &a, const B &b) -> decltype(a > b ? a : b) {
+    return a < b ? b : a;
+}
+
+using std::abs;
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+// time
+uint32_t millis();
+
+uint32_t micros();
+
+void delay(uint32_t milliseconds);
+
+void delayMicroseconds(uint32_t microseconds);
+
+void yield();
+
+// pins
+void pinMode(uint8_t pin, uint8_t mode);
+
+void digitalWrite(uint8_t pin, uint8_t value);
+
+uint8_t digitalRead(uint8_t pin);
+
+void digitalWriteFast(uint8_t pin, uint8_t value);
+
+uint8_t digitalReadFast(uint8_t pin);
+
+int analogRead(uint8_t pin);
+
+void analogWrite(uint8_t pin, int value);
+
+void analogWriteFrequency(uint8_t pin, float frequency);
+
+void analogWriteResolution(unsigned int bits);
+
+void analogReadResolution(unsigned int bits);
+
+void analogReadAveraging(unsigned int samples);
+
+volatile uint32_t *portToggleRegister(uint8_t pin);
+
+volatile uint32_t *portSetRegister(uint8_t pin);
+
+volatile uint32_t *portClearRegister(uint8_t pin);
+
+uint32_t digitalPinToBitMask(uint8_t pin);
+
+// interrupts
+#define digitalPinToInterrupt(pin) (pin)
+
+void attachInterrupt(uint8_t pin, void (*function)(), int mode);
+
+void detachInterrupt(uint8_t pin);
+
+void noInterrupts();
+
+void interrupts();
+
+void __disable_irq();
+
+void __enable_irq();
+
+#define IRQ_ADC1 67
+
+void attachInterruptVector(int irq, void (*function)());
+
+#define NVIC_ENABLE_IRQ(irq)
+#define NVIC_DISABLE_IRQ(irq)
+#define NVIC_SET_PRIORITY(irq, priority)
+
+// cycle counter, reading it costs FakeHardware's clock read cost like any other clock read
+uint32_t fakeReadCycleCounter();
+
+inline volatile uint32_t ARM_DWT_CTRL;
+inline volatile uint32_t ARM_DEMCR;
+#define ARM_DWT_CYCCNT (fakeReadCycleCounter())
+#define ARM_DEMCR_TRCENA (1 << 24)
+#define ARM_DWT_CTRL_CYCCNTENA (1 << 0)
+
+// ADC1: writing a channel to HC0 starts a conversion, FakeHardware picks it up and raises IRQ_ADC1
+inline volatile uint32_t ADC1_HC0 = 0x1F;
+inline volatile uint32_t ADC1_R0;
+inline volatile uint32_t ADC1_HS;
+inline volatile uint32_t ADC1_CFG;
+inline volatile uint32_t ADC1_GC;
+#define ADC_HC_AIEN (1 << 7)
+#define ADC_HC_ADCH(n) ((n) & 0x1F)
+#define ADC_HS_COCO0 (1 << 0)
+
+// memory
+void *extmem_malloc(size_t size);
+
+void extmem_free(void *pointer);
+
+void *extmem_calloc(size_t count, size_t size);
+
+inline uint8_t external_psram_size = 8;
+
+// USB
+inline volatile uint8_t usb_configuration = 1;
+
+class usb_serial_class : public Print {
+public:
+    void begin(uint32_t) {
+    }
+
+    int available();
+
+    int read();
+
+    size_t write(uint8_t value) override;
+
+    size_t write(const uint8_t *buffer, size_t size) override;
+
+    void flush() override;
+
+    explicit operator bool() const {
+        return true;
+    }
+};
+
+extern usb_serial_class Serial;
+
+class usb_rawhid_class {
+public:
+    int available();
+
+    int recv(void *buffer, uint16_t timeout);
+
+    int send(const void *buffer, uint16_t timeout);
+};
+
+extern usb_rawhid_class RawHID;
+
+#include "IntervalTimer.h"
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Arduino.h>
+
+/// The Teensy 4.1 EEPROM emulation size, starts out erased (0xFF)
+class EEPROMClass {
+public:
+    static constexpr int SIZE = 4284;
+
+    EEPROMClass() {
+        memset(data, 0xFF, sizeof(data));
+    }
+
+    uint8_t read(const int address) const {
+        return data[address];
+    }
+
+    void write(const int address, const uint8_t value) {
+        data[address] = value;
+    }
+
+    void update(const int address, const uint8_t value) {
+        data[address] = value;
+    }
+
+    template<typename T>
+    T &get(const int address, T &value) const {
+        memcpy(&value, &data[address], sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    const T &put(const int address, const T &value) {
+        memcpy(&data[address], &value, sizeof(T));
+        return value;
+    }
+
+    static uint16_t length() {
+        return SIZE;
+    }
+
+private:
+    uint8_t data[SIZE]{};
+};
+
+inline EEPROMClass EEPROM;
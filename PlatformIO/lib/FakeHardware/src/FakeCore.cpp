@@ -0,0 +1,459 @@
+#include "Arduino.h"
+#include "FakeHardware.h"
+#include <deque>
+#include <map>
+#include <string>
+
+
+namespace {
+    struct Timer {
+        void (*function)() = nullptr;
+        uint64_t periodCycles = 0;
+        uint64_t nextCycles = 0;
+    };
+
+    struct Event {
+        uint64_t dueCycles;
+        uint64_t order;
+        std::function<void()> function;
+    };
+
+    struct PinInterrupt {
+        void (*function)() = nullptr;
+        int mode = 0;
+    };
+
+    // the Teensy has four PIT channels
+    constexpr int TIMER_SLOTS = 4;
+
+    uint64_t now = 0;
+    uint64_t eventOrder = 0;
+    bool inInterrupt = false;
+    Timer timers[TIMER_SLOTS];
+    std::vector<Event> events;
+    uint8_t pinLevels[NUM_DIGITAL_PINS]{};
+    uint8_t pinModes[NUM_DIGITAL_PINS]{};
+    int analogWrites[NUM_DIGITAL_PINS]{};
+    volatile uint32_t portRegisters[NUM_DIGITAL_PINS]{};
+    PinInterrupt pinInterrupts[NUM_DIGITAL_PINS];
+    void (*adcVector)() = nullptr;
+    std::function<int(uint8_t)> analogSource;
+    std::function<uint16_t(uint8_t)> adcSource;
+    std::function<void(uint8_t, uint8_t)> pinWriteListener;
+    std::map<uint8_t, uint16_t> expanderPins; // address -> pins that read LOW
+    std::deque<std::vector<uint8_t> > rawhidIn;
+    std::vector<std::vector<uint8_t> > rawhidOut;
+    std::string serialIn;
+    bool serialEcho = false;
+
+    uint64_t readClock() {
+        now += fake::CLOCK_READ_CYCLES;
+        return now;
+    }
+
+    // an ADC1_HC0 write with a real channel starts a conversion that completes a little later
+    void checkAdcStart() {
+        const uint32_t hc0 = ADC1_HC0;
+        if ((hc0 & 0x1F) == 0x1F) {
+            return;
+        }
+        ADC1_HC0 = 0x1F;
+        const auto channel = static_cast<uint8_t>(hc0 & 0x1F);
+        const bool interrupt = hc0 & ADC_HC_AIEN;
+        events.push_back({now + fake::ADC_CONVERSION_CYCLES, eventOrder++, [channel, interrupt] {
+            ADC1_R0 = adcSource ? adcSource(channel) : 0;
+            ADC1_HS |= ADC_HS_COCO0;
+            if (interrupt && adcVector != nullptr) {
+                adcVector();
+            }
+        }});
+    }
+
+    void runInterrupt(const std::function<void()> &function) {
+        inInterrupt = true;
+        function();
+        checkAdcStart();
+        inInterrupt = false;
+    }
+
+    // runs the earliest timer or event due at or before the limit, returns false if there is none
+    bool runNext(const uint64_t limit) {
+        int timer = -1;
+        for (int i = 0; i < TIMER_SLOTS; i++) {
+            if (timers[i].function != nullptr && (timer < 0 || timers[i].nextCycles < timers[timer].nextCycles)) {
+                timer = i;
+            }
+        }
+        auto event = events.end();
+        for (auto it = events.begin(); it != events.end(); ++it) {
+            if (event == events.end() || it->dueCycles < event->dueCycles ||
+                (it->dueCycles == event->dueCycles && it->order < event->order)) {
+                event = it;
+            }
+        }
+        // pending events (pin interrupts, ADC completion) go before a timer due at the same time
+        const bool useEvent = event != events.end() && (timer < 0 || event->dueCycles <= timers[timer].nextCycles);
+        if (useEvent && event->dueCycles <= limit) {
+            now = max(now, event->dueCycles);
+            const std::function<void()> function = std::move(event->function);
+            events.erase(event);
+            runInterrupt(function);
+            return true;
+        }
+        if (!useEvent && timer >= 0 && timers[timer].nextCycles <= limit) {
+            now = max(now, timers[timer].nextCycles);
+            timers[timer].nextCycles += timers[timer].periodCycles;
+            runInterrupt(timers[timer].function);
+            return true;
+        }
+        return false;
+    }
+
+    // like the GPIO edge detection, an attached interrupt sees the pin change whoever drives it
+    void setLevel(const uint8_t pin, const uint8_t level) {
+        const uint8_t previous = pinLevels[pin];
+        pinLevels[pin] = level ? HIGH : LOW;
+        const PinInterrupt &interrupt = pinInterrupts[pin];
+        if (interrupt.function == nullptr || previous == pinLevels[pin]) {
+            return;
+        }
+        if (interrupt.mode == CHANGE || (interrupt.mode == RISING && pinLevels[pin] == HIGH) ||
+            (interrupt.mode == FALLING && pinLevels[pin] == LOW)) {
+            // pending like a real interrupt flag, it runs as soon as the current context allows
+            events.push_back({now, eventOrder++, interrupt.function});
+        }
+    }
+
+    void service(const uint64_t limit) {
+        if (inInterrupt) {
+            now = max(now, limit);
+            return;
+        }
+        checkAdcStart();
+        while (runNext(limit)) {
+        }
+        now = max(now, limit);
+    }
+}
+
+usb_serial_class Serial;
+usb_rawhid_class RawHID;
+
+// time
+
+uint32_t fakeReadCycleCounter() {
+    return static_cast<uint32_t>(readClock());
+}
+
+uint32_t millis() {
+    return static_cast<uint32_t>(readClock() / (fake::CYCLES_PER_MICRO * 1000ULL));
+}
+
+uint32_t micros() {
+    return static_cast<uint32_t>(readClock() / fake::CYCLES_PER_MICRO);
+}
+
+void delay(const uint32_t milliseconds) {
+    fake::advanceMicros(milliseconds * 1000);
+}
+
+void delayMicroseconds(const uint32_t microseconds) {
+    fake::advanceMicros(microseconds);
+}
+
+void yield() {
+    fake::advanceMicros(1);
+}
+
+long map(const long x, const long inMin, const long inMax, const long outMin, const long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// pins
+
+void pinMode(const uint8_t pin, const uint8_t mode) {
+    if (pin < NUM_DIGITAL_PINS) {
+        pinModes[pin] = mode;
+        if (mode == INPUT_PULLUP) {
+            pinLevels[pin] = HIGH;
+        }
+    }
+}
+
+void digitalWrite(const uint8_t pin, const uint8_t value) {
+    if (pin >= NUM_DIGITAL_PINS) {
+        return;
+    }
+    setLevel(pin, value);
+    if (pinWriteListener) {
+        pinWriteListener(pin, pinLevels[pin]);
+    }
+}
+
+uint8_t digitalRead(const uint8_t pin) {
+    return pin < NUM_DIGITAL_PINS ? pinLevels[pin] : LOW;
+}
+
+void digitalWriteFast(const uint8_t pin, const uint8_t value) {
+    digitalWrite(pin, value);
+}
+
+uint8_t digitalReadFast(const uint8_t pin) {
+    return digitalRead(pin);
+}
+
+int analogRead(const uint8_t pin) {
+    return analogSource ? analogSource(pin) : 0;
+}
+
+void analogWrite(const uint8_t pin, const int value) {
+    if (pin < NUM_DIGITAL_PINS) {
+        analogWrites[pin] = value;
+    }
+}
+
+void analogWriteFrequency(uint8_t, float) {
+}
+
+void analogWriteResolution(unsigned int) {
+}
+
+void analogReadResolution(unsigned int) {
+}
+
+void analogReadAveraging(unsigned int) {
+}
+
+// every pin sits on a port of its own, writes to the port registers have no effect
+volatile uint32_t *portToggleRegister(const uint8_t pin) {
+    return &portRegisters[pin % NUM_DIGITAL_PINS];
+}
+
+volatile uint32_t *portSetRegister(const uint8_t pin) {
+    return &portRegisters[pin % NUM_DIGITAL_PINS];
+}
+
+volatile uint32_t *portClearRegister(const uint8_t pin) {
+    return &portRegisters[pin % NUM_DIGITAL_PINS];
+}
+
+uint32_t digitalPinToBitMask(uint8_t) {
+    return 1;
+}
+
+// interrupts
+
+void attachInterrupt(const uint8_t pin, void (*function)(), const int mode) {
+    if (pin < NUM_DIGITAL_PINS) {
+        pinInterrupts[pin] = {function, mode};
+    }
+}
+
+void detachInterrupt(const uint8_t pin) {
+    if (pin < NUM_DIGITAL_PINS) {
+        pinInterrupts[pin] = {};
+    }
+}
+
+// interrupts only ever run between firmware statements, so masking them is a no-op
+void noInterrupts() {
+}
+
+void interrupts() {
+}
+
+void __disable_irq() {
+}
+
+void __enable_irq() {
+}
+
+void attachInterruptVector(const int irq, void (*function)()) {
+    if (irq == IRQ_ADC1) {
+        adcVector = function;
+    }
+}
+
+// memory
+
+void *extmem_malloc(const size_t size) {
+    return malloc(size);
+}
+
+void extmem_free(void *pointer) {
+    free(pointer);
+}
+
+void *extmem_calloc(const size_t count, const size_t size) {
+    return calloc(count, size);
+}
+
+// USB
+
+int usb_serial_class::available() {
+    return static_cast<int>(serialIn.size());
+}
+
+int usb_serial_class::read() {
+    if (serialIn.empty()) {
+        return -1;
+    }
+    const int value = static_cast<uint8_t>(serialIn.front());
+    serialIn.erase(serialIn.begin());
+    return value;
+}
+
+size_t usb_serial_class::write(const uint8_t value) {
+    if (serialEcho) {
+        fputc(value, stdout);
+    }
+    return 1;
+}
+
+size_t usb_serial_class::write(const uint8_t *buffer, const size_t size) {
+    if (serialEcho) {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
+
+void usb_serial_class::flush() {
+    if (serialEcho) {
+        fflush(stdout);
+    }
+}
+
+int usb_rawhid_class::available() {
+    return static_cast<int>(rawhidIn.size());
+}
+
+int usb_rawhid_class::recv(void *buffer, uint16_t) {
+    if (rawhidIn.empty()) {
+        return 0;
+    }
+    memcpy(buffer, rawhidIn.front().data(), 64);
+    rawhidIn.pop_front();
+    return 64;
+}
+
+int usb_rawhid_class::send(const void *buffer, uint16_t) {
+    const auto *bytes = static_cast<const uint8_t *>(buffer);
+    rawhidOut.emplace_back(bytes, bytes + 64);
+    return 64;
+}
+
+// IntervalTimer
+
+IntervalTimer::~IntervalTimer() {
+    end();
+}
+
+bool IntervalTimer::begin(void (*_function)(), const uint32_t _periodMicros) {
+    end();
+    for (int i = 0; i < TIMER_SLOTS; i++) {
+        if (timers[i].function == nullptr) {
+            slot = i;
+            timers[i].function = _function;
+            timers[i].periodCycles = static_cast<uint64_t>(max(_periodMicros, 1u)) * fake::CYCLES_PER_MICRO;
+            timers[i].nextCycles = now + timers[i].periodCycles;
+            return true;
+        }
+    }
+    return false;
+}
+
+void IntervalTimer::end() {
+    if (slot >= 0) {
+        timers[slot] = {};
+        slot = -1;
+    }
+}
+
+void IntervalTimer::update(const uint32_t _periodMicros) {
+    if (slot >= 0) {
+        timers[slot].periodCycles = static_cast<uint64_t>(max(_periodMicros, 1u)) * fake::CYCLES_PER_MICRO;
+    }
+}
+
+// control side
+
+namespace fake {
+    uint64_t nowCycles() {
+        return now;
+    }
+
+    void advanceMicros(const uint32_t micros) {
+        service(now + static_cast<uint64_t>(micros) * CYCLES_PER_MICRO);
+    }
+
+    void runDue() {
+        service(now);
+    }
+
+    void schedule(const uint32_t delayMicros, std::function<void()> event) {
+        events.push_back({now + static_cast<uint64_t>(delayMicros) * CYCLES_PER_MICRO, eventOrder++, std::move(event)});
+    }
+
+    uint8_t getPinLevel(const uint8_t pin) {
+        return digitalRead(pin);
+    }
+
+    uint8_t getPinMode(const uint8_t pin) {
+        return pin < NUM_DIGITAL_PINS ? pinModes[pin] : INPUT;
+    }
+
+    void setPinInput(const uint8_t pin, const uint8_t level) {
+        if (pin < NUM_DIGITAL_PINS) {
+            setLevel(pin, level);
+        }
+    }
+
+    int getAnalogWrite(const uint8_t pin) {
+        return pin < NUM_DIGITAL_PINS ? analogWrites[pin] : 0;
+    }
+
+    void setAnalogRead(std::function<int(uint8_t pin)> source) {
+        analogSource = std::move(source);
+    }
+
+    void setAdcSource(std::function<uint16_t(uint8_t adcChannel)> source) {
+        adcSource = std::move(source);
+    }
+
+    void onPinWrite(std::function<void(uint8_t pin, uint8_t level)> listener) {
+        pinWriteListener = std::move(listener);
+    }
+
+    void setExpanderPin(const uint8_t address, const uint8_t pin, const bool level) {
+        if (level) {
+            expanderPins[address] &= ~(1 << pin);
+        } else {
+            expanderPins[address] |= 1 << pin;
+        }
+    }
+
+    bool getExpanderPin(const uint8_t address, const uint8_t pin) {
+        const auto it = expanderPins.find(address);
+        return it == expanderPins.end() || (it->second & (1 << pin)) == 0;
+    }
+
+    void injectRawHID(const uint8_t *packet) {
+        rawhidIn.emplace_back(packet, packet + 64);
+    }
+
+    size_t pendingRawHID() {
+        return rawhidIn.size();
+    }
+
+    std::vector<std::vector<uint8_t> > &sentRawHID() {
+        return rawhidOut;
+    }
+
+    void injectSerial(const char *text) {
+        serialIn += text;
+    }
+
+    void setSerialEcho(const bool echo) {
+        serialEcho = echo;
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Control side of the host build: simulated time, pins, USB and peripherals
+ *
+ * The firmware only sees the Arduino/Teensy API from Arduino.h. Harnesses (benchmark, simulator) use these
+ * functions to move time forward, feed inputs and look at what the firmware did.
+ */
+namespace fake {
+    static constexpr uint32_t CYCLES_PER_MICRO = 600;
+    /// Cost of reading any clock, keeps busy-wait loops finite
+    static constexpr uint32_t CLOCK_READ_CYCLES = 10;
+    static constexpr uint32_t ADC_CONVERSION_CYCLES = 600;
+
+    uint64_t nowCycles();
+
+    /// Runs timers, pin interrupts and scheduled events until simulated time has moved on by this much
+    void advanceMicros(uint32_t micros);
+
+    /// Runs whatever is due right now without moving time
+    void runDue();
+
+    void schedule(uint32_t delayMicros, std::function<void()> event);
+
+    // pins
+    uint8_t getPinLevel(uint8_t pin);
+
+    uint8_t getPinMode(uint8_t pin);
+
+    /// Drives an input from outside, fires an attached interrupt on a matching edge
+    void setPinInput(uint8_t pin, uint8_t level);
+
+    int getAnalogWrite(uint8_t pin);
+
+    void setAnalogRead(std::function<int(uint8_t pin)> source);
+
+    /// ADC1 input channel to conversion result, for conversions started through ADC1_HC0
+    void setAdcSource(std::function<uint16_t(uint8_t adcChannel)> source);
+
+    void onPinWrite(std::function<void(uint8_t pin, uint8_t level)> listener);
+
+    // IO expanders (RoxMCP23017), every pin reads HIGH until set
+    void setExpanderPin(uint8_t address, uint8_t pin, bool level);
+
+    bool getExpanderPin(uint8_t address, uint8_t pin);
+
+    // USB
+    void injectRawHID(const uint8_t *packet);
+
+    [[nodiscard]] size_t pendingRawHID();
+
+    std::vector<std::vector<uint8_t> > &sentRawHID();
+
+    void injectSerial(const char *text);
+
+    /// Echo Serial output to stdout (off by default)
+    void setSerialEcho(bool echo);
+
+    // display
+    struct DisplayStats {
+        uint64_t pixelsSent;
+        uint32_t fullFrames;
+        uint32_t asyncFrames;
+        uint32_t windows;
+    };
+
+    DisplayStats getDisplayStats();
+
+    void resetDisplayStats();
+}
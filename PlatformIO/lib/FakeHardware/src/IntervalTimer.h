@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+/// Periodic interrupt, fired by FakeHardware whenever simulated time passes its next deadline
+class IntervalTimer {
+public:
+    IntervalTimer() = default;
+
+    ~IntervalTimer();
+
+    bool begin(void (*_function)(), uint32_t _periodMicros);
+
+    bool begin(void (*_function)(), int _periodMicros) {
+        return begin(_function, static_cast<uint32_t>(_periodMicros));
+    }
+
+    bool begin(void (*_function)(), float _periodMicros) {
+        return begin(_function, static_cast<uint32_t>(_periodMicros));
+    }
+
+    void end();
+
+    void update(uint32_t _periodMicros);
+
+    void priority(uint8_t) {
+    }
+
+private:
+    int slot = -1;
+};
@@ -0,0 +1,57 @@
+#include "Print.h"
+#include <cstdio>
+
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t written = 0;
+    while (size-- > 0) {
+        written += write(*buffer++);
+    }
+    return written;
+}
+
+size_t Print::print(const String &value) {
+    return write(reinterpret_cast<const uint8_t *>(value.c_str()), value.length());
+}
+
+size_t Print::print(const char *value) {
+    return write(reinterpret_cast<const uint8_t *>(value), strlen(value));
+}
+
+size_t Print::print(const char value) {
+    return write(static_cast<uint8_t>(value));
+}
+
+size_t Print::print(const int value, const int base) {
+    return print(String(static_cast<long>(value), base));
+}
+
+size_t Print::print(const unsigned int value, const int base) {
+    return print(String(static_cast<unsigned long>(value), base));
+}
+
+size_t Print::print(const long value, const int base) {
+    return print(String(value, base));
+}
+
+size_t Print::print(const unsigned long value, const int base) {
+    return print(String(value, base));
+}
+
+size_t Print::print(const double value, const int decimals) {
+    return print(String(value, decimals));
+}
+
+size_t Print::println() {
+    return print("\r\n");
+}
+
+int Print::printf(const char *format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    print(buffer);
+    return length;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include "WString.h"
+
+class Print {
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t value) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size);
+
+    size_t print(const String &value);
+
+    size_t print(const char *value);
+
+    size_t print(char value);
+
+    size_t print(int value, int base = DEC);
+
+    size_t print(unsigned int value, int base = DEC);
+
+    size_t print(long value, int base = DEC);
+
+    size_t print(unsigned long value, int base = DEC);
+
+    size_t print(double value, int decimals = 2);
+
+    template<typename T>
+    size_t println(const T &value) {
+        return print(value) + println();
+    }
+
+    size_t println();
+
+    int printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+    virtual void flush() {
+    }
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+
+class ResponsiveAnalogRead {
+public:
+    ResponsiveAnalogRead(const int _pin, const bool _sleepEnable) : pin(_pin) {
+        (void) _sleepEnable;
+    }
+
+    void update() {
+        value = analogRead(pin);
+    }
+
+    [[nodiscard]] int getValue() const {
+        return value;
+    }
+
+private:
+    int pin;
+    int value = 0;
+};
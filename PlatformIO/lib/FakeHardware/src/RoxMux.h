@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Arduino.h>
+#include "FakeHardware.h"
+
+/// MCP23017 whose pins are set from the harness through fake::setExpanderPin()
+template<uint8_t ADDRESS>
+class RoxMCP23017 {
+public:
+    void begin(bool) {
+    }
+
+    void pinMode(uint8_t, uint8_t) {
+    }
+
+    void update() {
+        for (uint8_t pin = 0; pin < 16; pin++) {
+            levels[pin] = fake::getExpanderPin(ADDRESS, pin);
+        }
+    }
+
+    [[nodiscard]] bool digitalRead(const uint8_t pin) const {
+        return levels[pin % 16];
+    }
+
+private:
+    bool levels[16] = {true, true, true, true, true, true, true, true,
+                       true, true, true, true, true, true, true, true};
+};
+
+/// Quadrature decoding on the A channel edges, one step per edge
+class RoxEncoder {
+public:
+    void begin() {
+    }
+
+    void update(const bool a, const bool b, uint8_t, const bool activeState) {
+        if (a != lastA) {
+            lastA = a;
+            if (a == activeState) {
+                moved = true;
+                clockwise = b != activeState;
+            }
+        }
+    }
+
+    bool read() {
+        const bool result = moved;
+        moved = false;
+        return result;
+    }
+
+    [[nodiscard]] bool increased() const {
+        return clockwise;
+    }
+
+private:
+    bool lastA = true;
+    bool moved = false;
+    bool clockwise = false;
+};
+
+/// Reports a press once when the input turns active, no debouncing
+class RoxButton {
+public:
+    void begin() {
+    }
+
+    void update(const bool state, uint16_t, const bool activeState) {
+        const bool active = state == activeState;
+        justPressed = active && !wasActive;
+        wasActive = active;
+    }
+
+    [[nodiscard]] bool pressed() const {
+        return justPressed;
+    }
+
+private:
+    bool wasActive = false;
+    bool justPressed = false;
+};
@@ -0,0 +1,138 @@
+#include "ST7789_t3.h"
+#include "FakeHardware.h"
+
+
+namespace {
+    fake::DisplayStats displayStats{};
+
+    uint64_t transferCycles(const uint32_t pixels) {
+        return static_cast<uint64_t>(pixels) * 16 * fake::CYCLES_PER_MICRO * 1000000 / ST7735_t3::SPI_CLOCK;
+    }
+}
+
+ST7735_t3::ST7735_t3(int8_t, uint8_t, uint8_t) {
+}
+
+ST7735_t3::~ST7735_t3() {
+    if (ownsFrameBuffer) {
+        free(_pfbtft);
+    }
+}
+
+// no font, characters only advance the cursor by the 5x7 glyph cell
+size_t ST7735_t3::write(const uint8_t character) {
+    if (character == '\n') {
+        cursorX = 0;
+        cursorY += textSize * 8;
+    } else if (character != '\r') {
+        if (wrap && cursorX + textSize * 6 > _width) {
+            cursorX = 0;
+            cursorY += textSize * 8;
+        }
+        cursorX += textSize * 6;
+    }
+    return 1;
+}
+
+void ST7735_t3::fillScreen(const uint16_t color) {
+    fillRect(0, 0, _width, _height, color);
+}
+
+void ST7735_t3::fillRect(const int16_t x, const int16_t y, const int16_t w, const int16_t h, const uint16_t color) {
+    if (_pfbtft == nullptr) {
+        return;
+    }
+    const int right = min(x + w, static_cast<int>(_width));
+    const int bottom = min(y + h, static_cast<int>(_height));
+    for (int row = max(static_cast<int>(y), 0); row < bottom; row++) {
+        for (int column = max(static_cast<int>(x), 0); column < right; column++) {
+            _pfbtft[row * _width + column] = color;
+        }
+    }
+}
+
+void ST7735_t3::drawPixel(const int16_t x, const int16_t y, const uint16_t color) {
+    if (_pfbtft != nullptr && x >= 0 && y >= 0 && x < _width && y < _height) {
+        _pfbtft[y * _width + x] = color;
+    }
+}
+
+// like the library with a frame buffer: clipped once, then copied row by row
+void ST7735_t3::writeRect(const int16_t x, const int16_t y, const int16_t w, const int16_t h,
+                          const uint16_t *pixels) {
+    const int left = max(static_cast<int>(x), 0);
+    const int right = min(x + w, static_cast<int>(_width));
+    if (_pfbtft == nullptr || left >= right) {
+        return;
+    }
+    for (int row = max(static_cast<int>(y), 0); row < min(y + h, static_cast<int>(_height)); row++) {
+        memcpy(&_pfbtft[row * _width + left], &pixels[(row - y) * w + left - x], (right - left) * sizeof(uint16_t));
+    }
+}
+
+void ST7735_t3::useFrameBuffer(const bool enable) {
+    if (enable && _pfbtft == nullptr) {
+        _pfbtft = static_cast<uint16_t *>(calloc(_width * _height, sizeof(uint16_t)));
+        ownsFrameBuffer = true;
+    }
+    _use_fbtft = enable;
+}
+
+void ST7735_t3::updateScreen() {
+    waitUpdateAsyncComplete();
+    send(_width * _height);
+    displayStats.fullFrames++;
+    fake::advanceMicros(transferCycles(_width * _height) / fake::CYCLES_PER_MICRO);
+}
+
+bool ST7735_t3::updateScreenAsync(bool) {
+    if (!_use_fbtft || asyncUpdateActive()) {
+        return false;
+    }
+    send(_width * _height);
+    displayStats.asyncFrames++;
+    asyncDoneCycles = fake::nowCycles() + transferCycles(_width * _height);
+    return true;
+}
+
+bool ST7735_t3::asyncUpdateActive() const {
+    return fake::nowCycles() < asyncDoneCycles;
+}
+
+void ST7735_t3::waitUpdateAsyncComplete() {
+    if (asyncUpdateActive()) {
+        fake::advanceMicros((asyncDoneCycles - fake::nowCycles()) / fake::CYCLES_PER_MICRO + 1);
+    }
+}
+
+void ST7735_t3::setAddr(uint16_t, uint16_t, uint16_t, uint16_t) {
+    pixelsInWindow = 0;
+    displayStats.windows++;
+}
+
+// a window is sent synchronously, so it costs its transfer time right away
+void ST7735_t3::writedata16_last(uint16_t) {
+    pixelsInWindow++;
+    send(pixelsInWindow);
+    fake::advanceMicros(transferCycles(pixelsInWindow) / fake::CYCLES_PER_MICRO);
+    pixelsInWindow = 0;
+}
+
+void ST7735_t3::send(const uint32_t pixels) const {
+    displayStats.pixelsSent += pixels;
+}
+
+void ST7789_t3::init(const uint16_t width, const uint16_t height, uint8_t) {
+    _width = static_cast<int16_t>(width);
+    _height = static_cast<int16_t>(height);
+}
+
+namespace fake {
+    DisplayStats getDisplayStats() {
+        return displayStats;
+    }
+
+    void resetDisplayStats() {
+        displayStats = {};
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define ST7735_RAMWR 0x2C
+#define ST77XX_BLACK 0x0000
+#define ST77XX_WHITE 0xFFFF
+#define ST77XX_RED 0xF800
+#define ST77XX_GREEN 0x07E0
+#define ST77XX_BLUE 0x001F
+#define SPI_MODE0 0x00
+#define SPI_MODE2 0x08
+
+/**
+ * @brief Frame buffer side of ST7735_t3 for host builds
+ *
+ * Drawing goes into the frame buffer like on the Teensy (text only moves the cursor, there is no font).
+ * Sending takes simulated time at the SPI clock: updateScreenAsync() stays active until the frame would be
+ * out, and every transfer is counted in fake::getDisplayStats().
+ */
+class ST7735_t3 : public Print {
+public:
+    static constexpr uint32_t SPI_CLOCK = 30000000;
+
+    ST7735_t3(int8_t _cs, uint8_t _dc, uint8_t _rst);
+
+    ~ST7735_t3() override;
+
+    size_t write(uint8_t character) override;
+
+    using Print::write;
+
+    void fillScreen(uint16_t color);
+
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color);
+
+    void writeRect(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels);
+
+    void setTextColor(uint16_t color) {
+        textColor = color;
+    }
+
+    void setTextColor(uint16_t color, uint16_t) {
+        textColor = color;
+    }
+
+    void setTextSize(uint8_t size) {
+        textSize = size;
+    }
+
+    void setTextWrap(bool _wrap) {
+        wrap = _wrap;
+    }
+
+    void setCursor(int16_t x, int16_t y) {
+        cursorX = x;
+        cursorY = y;
+    }
+
+    [[nodiscard]] int16_t getCursorX() const {
+        return cursorX;
+    }
+
+    [[nodiscard]] int16_t getCursorY() const {
+        return cursorY;
+    }
+
+    [[nodiscard]] int16_t width() const {
+        return _width;
+    }
+
+    [[nodiscard]] int16_t height() const {
+        return _height;
+    }
+
+    void useFrameBuffer(bool enable);
+
+    void setFrameBuffer(uint16_t *frameBuffer) {
+        _pfbtft = frameBuffer;
+    }
+
+    [[nodiscard]] uint16_t *getFrameBuffer() const {
+        return _pfbtft;
+    }
+
+    void updateScreen();
+
+    bool updateScreenAsync(bool updateContinuously = false);
+
+    [[nodiscard]] bool asyncUpdateActive() const;
+
+    void waitUpdateAsyncComplete();
+
+protected:
+    int16_t _width = 240;
+    int16_t _height = 240;
+    uint16_t *_pfbtft = nullptr;
+    uint8_t _use_fbtft = 0;
+
+    void beginSPITransaction() {
+    }
+
+    void endSPITransaction() {
+    }
+
+    void setAddr(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+
+    void writecommand_cont(uint8_t) {
+    }
+
+    void writedata16_cont(uint16_t) {
+        pixelsInWindow++;
+    }
+
+    void writedata16_last(uint16_t);
+
+private:
+    uint16_t textColor = ST77XX_WHITE;
+    uint8_t textSize = 1;
+    bool wrap = true;
+    int16_t cursorX = 0;
+    int16_t cursorY = 0;
+    bool ownsFrameBuffer = false;
+    uint64_t asyncDoneCycles = 0;
+    uint32_t pixelsInWindow = 0;
+
+    void send(uint32_t pixels) const;
+};
+
+class ST7789_t3 : public ST7735_t3 {
+public:
+    ST7789_t3(int8_t _cs, uint8_t _dc, uint8_t _rst) : ST7735_t3(_cs, _dc, _rst) {
+    }
+
+    void init(uint16_t width, uint16_t height, uint8_t mode = SPI_MODE0);
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define WS2812_RGB 0
+#define WS2812_GRB 1
+
+/// Keeps the pixel colours, show() copies them to the "displayed" set
+class WS2812Serial {
+public:
+    WS2812Serial(const uint16_t _numLeds, void *_displayMemory, void *_drawingMemory, const uint8_t _pin,
+                 const uint8_t _config) : numLeds(_numLeds) {
+        (void) _displayMemory;
+        (void) _drawingMemory;
+        (void) _pin;
+        (void) _config;
+        pixels = new uint32_t[numLeds]{};
+        shown = new uint32_t[numLeds]{};
+    }
+
+    ~WS2812Serial() {
+        delete[] pixels;
+        delete[] shown;
+    }
+
+    void begin() {
+    }
+
+    void setPixel(const uint32_t num, const uint32_t color) {
+        if (num < numLeds) {
+            pixels[num] = color;
+        }
+    }
+
+    [[nodiscard]] uint32_t getPixel(const uint32_t num) const {
+        return num < numLeds ? shown[num] : 0;
+    }
+
+    void clear() {
+        memset(pixels, 0, numLeds * sizeof(uint32_t));
+    }
+
+    void show() {
+        memcpy(shown, pixels, numLeds * sizeof(uint32_t));
+        shows++;
+    }
+
+    [[nodiscard]] bool busy() const {
+        return false;
+    }
+
+    [[nodiscard]] uint32_t getShowCount() const {
+        return shows;
+    }
+
+private:
+    uint16_t numLeds;
+    uint32_t *pixels;
+    uint32_t *shown;
+    uint32_t shows = 0;
+};
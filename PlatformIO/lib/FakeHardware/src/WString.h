@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#define HEX 16
+#define DEC 10
+
+/// Arduino String on top of std::string, only what the firmware uses
+class String {
+public:
+    String() = default;
+
+    String(const char *value) : data(value == nullptr ? "" : value) {
+    }
+
+    String(const std::string &value) : data(value) {
+    }
+
+    explicit String(char value) : data(1, value) {
+    }
+
+    String(unsigned char value, unsigned char base = DEC) : data(toDigits(static_cast<unsigned long>(value), base)) {
+    }
+
+    String(int value, unsigned char base = DEC) : data(base == DEC ? std::to_string(value) : toDigits(static_cast<unsigned long>(value), base)) {
+    }
+
+    String(unsigned int value, unsigned char base = DEC) : data(toDigits(static_cast<unsigned long>(value), base)) {
+    }
+
+    String(long value, unsigned char base = DEC) : data(base == DEC ? std::to_string(value) : toDigits(static_cast<unsigned long>(value), base)) {
+    }
+
+    String(unsigned long value, unsigned char base = DEC) : data(toDigits(static_cast<unsigned long>(value), base)) {
+    }
+
+    String(long long value) : data(std::to_string(value)) {
+    }
+
+    String(unsigned long long value) : data(std::to_string(value)) {
+    }
+
+    String(bool value) : data(value ? "1" : "0") {
+    }
+
+    String(float value, unsigned char decimals = 2) : data(toFixed(value, decimals)) {
+    }
+
+    String(double value, unsigned char decimals = 2) : data(toFixed(value, decimals)) {
+    }
+
+    [[nodiscard]] unsigned int length() const {
+        return data.length();
+    }
+
+    [[nodiscard]] const char *c_str() const {
+        return data.c_str();
+    }
+
+    char operator[](const unsigned int index) const {
+        return index < data.length() ? data[index] : '\0';
+    }
+
+    char &operator[](const unsigned int index) {
+        return data[index];
+    }
+
+    String &operator+=(const String &other) {
+        data += other.data;
+        return *this;
+    }
+
+    String &operator+=(const char *other) {
+        data += other;
+        return *this;
+    }
+
+    String &operator+=(const char other) {
+        // like the Teensy core, appending '\0' leaves the string as it is
+        if (other != '\0') {
+            data += other;
+        }
+        return *this;
+    }
+
+    friend String operator+(const String &a, const String &b) {
+        return String(a.data + b.data);
+    }
+
+    friend String operator+(const String &a, const char *b) {
+        return String(a.data + b);
+    }
+
+    friend String operator+(const char *a, const String &b) {
+        return String(a + b.data);
+    }
+
+    friend bool operator==(const String &a, const String &b) {
+        return a.data == b.data;
+    }
+
+    friend bool operator!=(const String &a, const String &b) {
+        return a.data != b.data;
+    }
+
+private:
+    std::string data;
+
+    static std::string toDigits(unsigned long long value, unsigned char base) {
+        if (value == 0) {
+            return "0";
+        }
+        std::string digits;
+        while (value > 0) {
+            digits.insert(digits.begin(), "0123456789ABCDEF"[value % base]);
+            value /= base;
+        }
+        return digits;
+    }
+
+    static std::string toFixed(double value, unsigned char decimals) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+        return buffer;
+    }
+};
@@ -0,0 +1,91 @@
+#include "smalloc.h"
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    struct Header {
+        size_t size; // bytes after the header up to the next one
+        size_t used; // 0 for a free block
+    };
+
+    constexpr size_t ALIGN = sizeof(Header);
+
+    Header *first(const smalloc_pool *spool) {
+        return static_cast<Header *>(spool->pool);
+    }
+
+    Header *next(const smalloc_pool *spool, Header *header) {
+        auto *following = reinterpret_cast<Header *>(reinterpret_cast<uint8_t *>(header + 1) + header->size);
+        return reinterpret_cast<uint8_t *>(following) < static_cast<uint8_t *>(spool->pool) + spool->pool_size
+                   ? following
+                   : nullptr;
+    }
+
+    Header *headerOf(const smalloc_pool *spool, const void *p) {
+        for (Header *header = first(spool); header != nullptr; header = next(spool, header)) {
+            if (header + 1 == p) {
+                return header->used > 0 ? header : nullptr;
+            }
+        }
+        return nullptr;
+    }
+}
+
+int sm_set_pool(smalloc_pool *spool, void *new_pool, const size_t new_pool_size, const int do_zero,
+                const smalloc_oom_handler oom_handler) {
+    if (spool == nullptr || new_pool == nullptr || new_pool_size < 2 * sizeof(Header)) {
+        return 0;
+    }
+    spool->pool = new_pool;
+    spool->pool_size = new_pool_size / ALIGN * ALIGN;
+    spool->do_zero = do_zero;
+    spool->oomfn = oom_handler;
+    *first(spool) = {spool->pool_size - sizeof(Header), 0};
+    return 1;
+}
+
+void *sm_malloc_pool(smalloc_pool *spool, const size_t n) {
+    if (spool == nullptr || spool->pool == nullptr || n == 0) {
+        return nullptr;
+    }
+    const size_t size = (n + ALIGN - 1) / ALIGN * ALIGN;
+    for (Header *header = first(spool); header != nullptr; header = next(spool, header)) {
+        // merge the free blocks behind this one
+        for (Header *following = next(spool, header); header->used == 0 && following != nullptr &&
+                                                      following->used == 0; following = next(spool, header)) {
+            header->size += sizeof(Header) + following->size;
+        }
+        if (header->used > 0 || header->size < size) {
+            continue;
+        }
+        if (header->size >= size + 2 * sizeof(Header)) {
+            auto *rest = reinterpret_cast<Header *>(reinterpret_cast<uint8_t *>(header + 1) + size);
+            *rest = {header->size - size - sizeof(Header), 0};
+            header->size = size;
+        }
+        header->used = n;
+        if (spool->do_zero) {
+            memset(header + 1, 0, header->size);
+        }
+        return header + 1;
+    }
+    if (spool->oomfn != nullptr) {
+        spool->oomfn(spool, n);
+    }
+    return nullptr;
+}
+
+void sm_free_pool(smalloc_pool *spool, void *p) {
+    if (spool == nullptr || p == nullptr) {
+        return;
+    }
+    Header *header = headerOf(spool, p);
+    if (header != nullptr) {
+        header->used = 0;
+    }
+}
+
+size_t sm_szalloc_pool(smalloc_pool *spool, const void *p) {
+    const Header *header = spool == nullptr ? nullptr : headerOf(spool, p);
+    return header == nullptr ? 0 : header->used;
+}
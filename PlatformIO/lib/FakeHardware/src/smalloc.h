@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+struct smalloc_pool;
+
+typedef size_t (*smalloc_oom_handler)(struct smalloc_pool *, size_t);
+
+struct smalloc_pool {
+    void *pool;
+    size_t pool_size;
+    int do_zero;
+    smalloc_oom_handler oomfn;
+};
+
+// the pool variants of the Teensy core's smalloc, first fit over a list of block headers inside the pool
+
+int sm_set_pool(struct smalloc_pool *spool, void *new_pool, size_t new_pool_size, int do_zero,
+                smalloc_oom_handler oom_handler);
+
+void *sm_malloc_pool(struct smalloc_pool *spool, size_t n);
+
+void sm_free_pool(struct smalloc_pool *spool, void *p);
+
+size_t sm_szalloc_pool(struct smalloc_pool *spool, const void *p);
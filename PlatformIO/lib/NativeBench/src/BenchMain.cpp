@@ -0,0 +1,775 @@
+/*
+ * Runs the firmware on FakeHardware and measures host time spent in loop(), idle and while packets come in.
+ *
+ *   .pio/build/native/program [idle loops] [recorded icon streams...]
+ *
+ * A recorded icon stream is the compressed icon exactly as the computer sends it (the ICON_PACKET payloads
+ * concatenated, without the padding of the last packet). They are replayed through the streaming decoder next to
+ * a few built-in ones.
+ *
+ * Icon throughput is in icons per second over a modelled link (LINK_PACKET_MICROS per packet, an ack reaching the
+ * host HOST_TURNAROUND_MICROS after it was sent), for a host waiting on every icon and for pipelined ones.
+ *
+ * Absolute numbers are for the host CPU, compare them between builds rather than against the Teensy.
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <deque>
+#include <string>
+#include <vector>
+#include "FakeHardware.h"
+#include "FastLZStream.h"
+#include "Globals.h"
+#include "DisplayScheduler.h"
+#include "FaderChannel.h"
+#include "FrameBufferPool.h"
+#include "IconCache.h"
+#include "IconStore.h"
+#include "IconRLE.h"
+#include "IconTransfers.h"
+#include "icons.h"
+#include "packets/PacketPositions.h"
+#include "packets/RecMultiMessage.h"
+#include "thirdparty/fastlz.h"
+
+void setup();
+
+void loop();
+
+extern IconCache iconCache;
+
+extern IconStore iconStore;
+
+extern IconTransfers iconTransfers;
+
+extern FaderChannel faderChannels[CHANNELS];
+
+extern FrameBufferPool frameBufferPool;
+
+extern DisplayScheduler displayScheduler;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    /// Simulated time between two loop() passes
+    constexpr uint32_t LOOP_STEP_MICROS = 20;
+    constexpr uint32_t DEFAULT_IDLE_LOOPS = 200000;
+    constexpr uint32_t FIRST_PID = 1001;
+    constexpr uint8_t PROCESSES = 3;
+    /// RawHID moves one packet per 125 us microframe, a host program takes about 1 ms from an ack being sent to
+    /// its answer leaving
+    constexpr uint32_t LINK_PACKET_MICROS = 125;
+    constexpr uint32_t HOST_TURNAROUND_MICROS = 1000;
+    constexpr uint32_t THROUGHPUT_ICONS = 200;
+    constexpr uint32_t REOPENS = 1000;
+
+    struct Timing {
+        const char *name;
+        uint32_t count = 0;
+        uint64_t totalNanos = 0;
+        uint64_t maxNanos = 0;
+
+        void add(const uint64_t nanos) {
+            count++;
+            totalNanos += nanos;
+            maxNanos = max(maxNanos, nanos);
+        }
+
+        void print() const {
+            printf("%-22s %8" PRIu32 " x  mean %9.2f us  max %9.2f us\n", name, count,
+                   count == 0 ? 0.0 : totalNanos / 1000.0 / count, maxNanos / 1000.0);
+        }
+    };
+
+    uint64_t nanosSince(const Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    void step() {
+        loop();
+        fake::advanceMicros(LOOP_STEP_MICROS);
+    }
+
+    struct Packet {
+        uint8_t data[PACKET_SIZE]{};
+
+        explicit Packet(const uint8_t status, const uint16_t count = 0) {
+            data[PacketPositions::Base::VERSION_INDEX] = API_VERSION;
+            memcpy(&data[PacketPositions::Base::COUNT_INDEX], &count, sizeof(count));
+            data[PacketPositions::Base::STATUS_INDEX] = status;
+        }
+
+        template<typename T>
+        void put(const uint8_t index, const T value) {
+            memcpy(&data[index], &value, sizeof(T));
+        }
+
+        void putName(const uint8_t index, const char *name) {
+            strncpy(reinterpret_cast<char *>(&data[index]), name, NAME_LENGTH_MAX - 1);
+        }
+    };
+
+    // host to firmware latency of one packet: from arrival until the loop() pass that handled it returns
+    void deliver(const Packet &packet, Timing &timing) {
+        fake::injectRawHID(packet.data);
+        const auto start = Clock::now();
+        while (fake::pendingRawHID() > 0) {
+            loop();
+        }
+        timing.add(nanosSince(start));
+        fake::advanceMicros(LOOP_STEP_MICROS);
+    }
+
+    // what the firmware sent since the last call, MULTI_MESSAGE reports unpacked
+    std::vector<std::vector<uint8_t> > sentMessages() {
+        std::vector<std::vector<uint8_t> > messages;
+        for (const auto &report: fake::sentRawHID()) {
+            if (report[PacketPositions::Base::STATUS_INDEX] != MULTI_MESSAGE) {
+                messages.push_back(report);
+                continue;
+            }
+            RecMultiMessage multiMessage(report.data());
+            std::vector<uint8_t> message(PACKET_SIZE);
+            while (multiMessage.next(message.data())) {
+                messages.push_back(message);
+            }
+        }
+        fake::sentRawHID().clear();
+        return messages;
+    }
+
+    // the list the firmware starts up with, every channel gets a process and asks for its data and icon
+    void answerProcessRequest(Timing &timing) {
+        using namespace PacketPositions;
+        constexpr uint8_t STARTUP_PROCESSES = CHANNELS - FIRST_CHANNEL;
+        Packet init(PROCESS_REQUEST_INIT);
+        init.put<uint8_t>(ProcessRequestInit::NUM_CHANNELS_INDEX, STARTUP_PROCESSES);
+        deliver(init, timing);
+        for (uint8_t process = 0; process < STARTUP_PROCESSES; process += 2) {
+            Packet processes(ALL_CURRENT_PROCESSES);
+            processes.put<uint32_t>(AllCurrentProcesses::PID_INDEX, FIRST_PID + process);
+            processes.putName(AllCurrentProcesses::NAME_INDEX, "bench process");
+            processes.put<uint32_t>(AllCurrentProcesses::PID_INDEX_2, FIRST_PID + process + 1);
+            processes.putName(AllCurrentProcesses::NAME_INDEX_2, "bench process");
+            deliver(processes, timing);
+        }
+    }
+
+    void sendVolumeLevels(const uint8_t level, Timing &timing) {
+        using Positions = PacketPositions::CurrentVolumeLevels;
+        Packet packet(SEND_CURRENT_VOLUME_LEVELS);
+        packet.put<uint8_t>(Positions::NUM_CHANNELS_INDEX, PROCESSES);
+        for (uint8_t process = 0; process < PROCESSES; process++) {
+            packet.put<uint32_t>(Positions::PID_INDEX + process * Positions::CHANNEL_SIZE, FIRST_PID + process);
+            packet.put<uint8_t>(Positions::VOLUME_INDEX + process * Positions::CHANNEL_SIZE, level);
+        }
+        deliver(packet, timing);
+    }
+
+    void sendChannelData(const uint8_t volume, Timing &timing) {
+        using Positions = PacketPositions::ChannelData;
+        Packet packet(CHANNEL_DATA);
+        packet.put<uint8_t>(Positions::IS_MASTER_INDEX, 0);
+        packet.put<uint8_t>(Positions::MAX_VOLUME_INDEX, volume);
+        packet.put<uint8_t>(Positions::IS_MUTED_INDEX, 0);
+        packet.put<uint32_t>(Positions::PID_INDEX, FIRST_PID);
+        packet.putName(Positions::NAME_INDEX, volume % 2 ? "renamed process" : "bench process");
+        deliver(packet, timing);
+    }
+
+    void sendIcon(const uint8_t *compressed, const uint32_t length, const IconCodec codec, Timing &packetTiming,
+                  Timing &iconTiming) {
+        using namespace PacketPositions;
+        const uint32_t packets = (length + IconPacket::NUM_ICON_BYTES_SENT - 1) / IconPacket::NUM_ICON_BYTES_SENT;
+        const auto start = Clock::now();
+        Packet init(ICON_PACKETS_INIT);
+        init.put<uint32_t>(IconPacketInit::ICON_PID_INDEX, FIRST_PID);
+        init.put<uint32_t>(IconPacketInit::ICON_PACKET_COUNT_INDEX, packets);
+        init.put<uint32_t>(IconPacketInit::ICON_BYTE_COUNT_INDEX, length);
+        init.put<uint8_t>(IconPacketInit::ICON_CODEC_INDEX, codec);
+        deliver(init, packetTiming);
+        for (uint32_t i = 0; i < packets; i++) {
+            Packet data(ICON_PACKET, static_cast<uint16_t>(i));
+            const uint32_t offset = i * IconPacket::NUM_ICON_BYTES_SENT;
+            memcpy(&data.data[IconPacket::ICON_INDEX], compressed + offset,
+                   min(static_cast<uint32_t>(IconPacket::NUM_ICON_BYTES_SENT), length - offset));
+            deliver(data, packetTiming);
+        }
+        while (iconTransfers.isReceiving()) {
+            step();
+        }
+        iconTiming.add(nanosSince(start));
+    }
+
+    struct Throughput {
+        uint32_t icons = 0;
+        uint32_t packets = 0;
+        uint32_t waits = 0; // times the host had nothing to send until an ack came back
+        uint64_t linkMicros = 0;
+        bool ok = false;
+    };
+
+    struct Host {
+        const char *name;
+        uint8_t window; // 0 is the API version 2 host
+        bool interleave; // round robin over the open transfers instead of the oldest first
+    };
+
+    constexpr Host HOSTS[] = {
+        {"stop and wait (API 2)", 0, false},
+        {"window 1", 1, false},
+        {"window 2", 2, false},
+        {"window 4", 4, false},
+        {"window 4, interleaved", 4, true},
+    };
+
+    // A host sending icons over the modelled link. The API version 2 host sends one icon at a time, the data only
+    // after the init was acked. Otherwise up to window transfers are open and a transfer is only over once its
+    // last cumulative ack came back.
+    Throughput transferIcons(const std::vector<uint8_t> &compressed, const uint32_t icons, const Host &host) {
+        using namespace PacketPositions;
+        struct Transfer {
+            uint8_t id;
+            uint32_t next;
+            bool opened;
+        };
+        struct Ack {
+            uint64_t seenAt;
+            uint8_t transfer;
+            uint16_t received;
+        };
+        const uint32_t length = compressed.size();
+        const uint32_t packets = (length + IconPacket::NUM_ICON_BYTES_SENT - 1) / IconPacket::NUM_ICON_BYTES_SENT;
+        const bool legacy = host.window == 0;
+        const IconTransfers::Stats before = iconTransfers.getStats();
+        Throughput result;
+        Timing timing{"icon packet"};
+        std::vector<Transfer> open;
+        std::deque<Ack> acks;
+        uint32_t started = 0;
+        uint32_t turn = 0;
+        bool stalled = false;
+        const auto send = [&](Packet &packet) {
+            if (legacy) {
+                packet.data[Base::VERSION_INDEX] = 2;
+            }
+            deliver(packet, timing);
+            result.packets++;
+            result.linkMicros += LINK_PACKET_MICROS;
+            for (const auto &sent: sentMessages()) {
+                if (sent[Base::STATUS_INDEX] == ACK && sent[AcknowledgePacket::ACK_TYPE_INDEX] == ICON_ACK) {
+                    uint16_t received;
+                    memcpy(&received, &sent[AcknowledgePacket::RECEIVED_INDEX], sizeof(received));
+                    acks.push_back({result.linkMicros + HOST_TURNAROUND_MICROS,
+                                    sent[AcknowledgePacket::TRANSFER_INDEX], received});
+                }
+            }
+        };
+        while (result.icons < icons) {
+            while (!acks.empty() && acks.front().seenAt <= result.linkMicros) {
+                for (auto transfer = open.begin(); transfer != open.end(); ++transfer) {
+                    if (transfer->id == acks.front().transfer) {
+                        transfer->opened = true;
+                        if (acks.front().received == packets) {
+                            open.erase(transfer);
+                            result.icons++;
+                        }
+                        break;
+                    }
+                }
+                acks.pop_front();
+            }
+            if (open.size() < max(host.window, static_cast<uint8_t>(1)) && started < icons) {
+                const uint8_t id = started % IconTransfers::TRANSFER_IDS;
+                Packet init(ICON_PACKETS_INIT);
+                init.put<uint32_t>(IconPacketInit::ICON_PID_INDEX, FIRST_PID + started % PROCESSES);
+                init.put<uint32_t>(IconPacketInit::ICON_PACKET_COUNT_INDEX, packets);
+                init.put<uint32_t>(IconPacketInit::ICON_BYTE_COUNT_INDEX, length);
+                init.put<uint8_t>(IconPacketInit::ICON_CODEC_INDEX, ICON_CODEC_FASTLZ);
+                init.put<uint8_t>(IconPacketInit::ICON_TRANSFER_INDEX, legacy ? 0 : id);
+                send(init);
+                stalled = false;
+                open.push_back({legacy ? static_cast<uint8_t>(0) : id, 0, false});
+                started++;
+                continue;
+            }
+            Transfer *next = nullptr;
+            for (size_t i = 0; i < open.size() && next == nullptr; i++) {
+                Transfer &candidate = open[host.interleave ? (turn + i) % open.size() : i];
+                if (candidate.next < packets && (candidate.opened || !legacy)) {
+                    next = &candidate;
+                }
+            }
+            if (next == nullptr) {
+                if (acks.empty()) {
+                    break; // the firmware stopped answering
+                }
+                result.linkMicros = max(result.linkMicros, acks.front().seenAt);
+                result.waits += !stalled;
+                stalled = true;
+                continue;
+            }
+            turn++;
+            Packet data(ICON_PACKET, static_cast<uint16_t>(next->next | next->id << IconPacket::TRANSFER_SHIFT));
+            const uint32_t offset = next->next * IconPacket::NUM_ICON_BYTES_SENT;
+            memcpy(&data.data[IconPacket::ICON_INDEX], compressed.data() + offset,
+                   min(static_cast<uint32_t>(IconPacket::NUM_ICON_BYTES_SENT), length - offset));
+            send(data);
+            stalled = false;
+            // the version 2 host knows nothing more about the transfer once it has sent everything
+            if (++next->next == packets && legacy) {
+                open.clear();
+                result.icons++;
+            }
+        }
+        const IconTransfers::Stats after = iconTransfers.getStats();
+        result.ok = result.icons == icons && after.completed - before.completed == icons &&
+                    after.failed == before.failed && after.dropped == before.dropped;
+        return result;
+    }
+
+    // false if any host did not get every icon through
+    bool printThroughput(const char *name, const std::vector<uint8_t> &compressed) {
+        const uint32_t packets = (compressed.size() + PacketPositions::IconPacket::NUM_ICON_BYTES_SENT - 1) /
+                                 PacketPositions::IconPacket::NUM_ICON_BYTES_SENT;
+        printf("\nicon throughput, %s: %" PRIu32 " packets per icon\n", name, packets);
+        printf("%-24s %7s %7s %7s %10s\n", "host", "icons", "packets", "waits", "icons/s");
+        bool ok = true;
+        for (const Host &host: HOSTS) {
+            const Throughput result = transferIcons(compressed, THROUGHPUT_ICONS, host);
+            printf("%-24s %7" PRIu32 " %7" PRIu32 " %7" PRIu32 " %10.0f%s\n", host.name, result.icons,
+                   result.packets, result.waits, result.icons / (result.linkMicros / 1e6), result.ok ? "" : "  FAILED");
+            ok &= result.ok;
+        }
+        return ok;
+    }
+
+    // the built-in icon as the computer would send it
+    const uint16_t *defaultIconPixels() {
+        static uint16_t pixels[ICON_SIZE * ICON_SIZE];
+        static const bool decoded = IconRLE::decompress(defaultIcon.rle, defaultIcon.length, pixels);
+        return decoded ? pixels : nullptr;
+    }
+
+    // drawing the built-in icon from flash must give the pixels decompress() does, timed against a plain blit
+    const char *checkBuiltinDraw(Timing &flashTiming, Timing &blitTiming) {
+        static uint16_t drawn[ICON_SIZE * ICON_SIZE];
+        IconRLE::draw(defaultIcon.rle, defaultIcon.length, [](void *, const uint8_t firstRow, const uint16_t *band) {
+            memcpy(drawn + firstRow * ICON_SIZE, band, IconRLE::BAND_ROWS * ICON_SIZE * sizeof(uint16_t));
+        }, nullptr);
+        for (int i = 0; i < 100; i++) {
+            auto start = Clock::now();
+            IconRLE::draw(defaultIcon.rle, defaultIcon.length, [](void *, const uint8_t firstRow,
+                                                                  const uint16_t *band) {
+                tft.writeRect(0, firstRow, ICON_SIZE, IconRLE::BAND_ROWS, band);
+            }, nullptr);
+            flashTiming.add(nanosSince(start));
+            start = Clock::now();
+            tft.writeRect(0, 0, ICON_SIZE, ICON_SIZE, defaultIconPixels());
+            blitTiming.add(nanosSince(start));
+        }
+        return memcmp(drawn, defaultIconPixels(), IconStore::ICON_BYTES) == 0 ? "ok" : "wrong pixels";
+    }
+
+    // the channel must show the received pixels from the very slot they were decoded into, which the cache shares
+    const char *checkReceivedIcon(const uint16_t *expected) {
+        for (const auto &channel: faderChannels) {
+            if (channel.appdata.PID != FIRST_PID) {
+                continue;
+            }
+            const uint16_t *shown = iconStore.get(channel.getIcon());
+            if (shown == nullptr || memcmp(shown, expected, IconStore::ICON_BYTES) != 0) {
+                return "wrong pixels";
+            }
+            if (iconCache.find(FIRST_PID, channel.appdata.name) != channel.getIcon()) {
+                return "not shared with the cache";
+            }
+            return "ok";
+        }
+        return "no channel";
+    }
+
+    // the icon as drawIcon() used to draw it, a drawPixel() per pixel from a column-major buffer, against the
+    // single writeRect() of the row-major slot it draws now; both must leave the same frame buffer
+    const char *checkIconDraw(Timing &pixelTiming, Timing &rectTiming) {
+        static uint16_t columns[ICON_SIZE][ICON_SIZE];
+        static uint16_t perPixel[ICON_SIZE * ICON_SIZE];
+        const uint16_t *pixels = defaultIconPixels();
+        for (uint8_t y = 0; y < ICON_SIZE; y++) {
+            for (uint8_t x = 0; x < ICON_SIZE; x++) {
+                columns[x][y] = pixels[y * ICON_SIZE + x];
+            }
+        }
+        const uint16_t *frame = tft.getFrameBuffer();
+        if (frame == nullptr) {
+            return "no frame buffer";
+        }
+        for (int i = 0; i < 100; i++) {
+            auto start = Clock::now();
+            for (uint16_t x = 0; x < ICON_SIZE; x++) {
+                for (uint16_t y = 0; y < ICON_SIZE; y++) {
+                    tft.drawPixel(x, y, columns[x][y]);
+                }
+            }
+            pixelTiming.add(nanosSince(start));
+            for (uint8_t y = 0; y < ICON_SIZE; y++) {
+                memcpy(&perPixel[y * ICON_SIZE], &frame[y * tft.width()], ICON_SIZE * sizeof(uint16_t));
+            }
+            start = Clock::now();
+            tft.writeRect(0, 0, ICON_SIZE, ICON_SIZE, pixels);
+            rectTiming.add(nanosSince(start));
+        }
+        for (uint8_t y = 0; y < ICON_SIZE; y++) {
+            if (memcmp(&perPixel[y * ICON_SIZE], &frame[y * tft.width()], ICON_SIZE * sizeof(uint16_t)) != 0 ||
+                memcmp(&perPixel[y * ICON_SIZE], &pixels[y * ICON_SIZE], ICON_SIZE * sizeof(uint16_t)) != 0) {
+                return "wrong pixels";
+            }
+        }
+        return "ok";
+    }
+
+    // a lost packet is dropped with the ones after it, the ack for the gap tells the host where to resume
+    const char *checkLostPacket(const std::vector<uint8_t> &compressed) {
+        using namespace PacketPositions;
+        constexpr uint8_t TRANSFER = 5;
+        constexpr uint16_t LOST = 3;
+        const uint32_t length = compressed.size();
+        const uint32_t packets = (length + IconPacket::NUM_ICON_BYTES_SENT - 1) / IconPacket::NUM_ICON_BYTES_SENT;
+        Timing timing{"icon packet"};
+        const auto sendPacket = [&](const uint32_t index) {
+            Packet data(ICON_PACKET, static_cast<uint16_t>(index | TRANSFER << IconPacket::TRANSFER_SHIFT));
+            const uint32_t offset = index * IconPacket::NUM_ICON_BYTES_SENT;
+            memcpy(&data.data[IconPacket::ICON_INDEX], compressed.data() + offset,
+                   min(static_cast<uint32_t>(IconPacket::NUM_ICON_BYTES_SENT), length - offset));
+            deliver(data, timing);
+        };
+        Packet init(ICON_PACKETS_INIT);
+        init.put<uint32_t>(IconPacketInit::ICON_PID_INDEX, FIRST_PID);
+        init.put<uint32_t>(IconPacketInit::ICON_PACKET_COUNT_INDEX, packets);
+        init.put<uint32_t>(IconPacketInit::ICON_BYTE_COUNT_INDEX, length);
+        init.put<uint8_t>(IconPacketInit::ICON_CODEC_INDEX, ICON_CODEC_FASTLZ);
+        init.put<uint8_t>(IconPacketInit::ICON_TRANSFER_INDEX, TRANSFER);
+        deliver(init, timing);
+        fake::sentRawHID().clear();
+        for (uint32_t i = 0; i < packets; i++) {
+            if (i != LOST) {
+                sendPacket(i);
+            }
+        }
+        uint32_t gapAcks = 0;
+        for (const auto &sent: sentMessages()) {
+            uint16_t received;
+            memcpy(&received, &sent[AcknowledgePacket::RECEIVED_INDEX], sizeof(received));
+            gapAcks += sent[Base::STATUS_INDEX] == ACK && sent[AcknowledgePacket::TRANSFER_INDEX] == TRANSFER &&
+                    received == LOST;
+        }
+        if (gapAcks != 1) {
+            return "no single ack for the gap";
+        }
+        for (uint32_t i = LOST; i < packets; i++) {
+            sendPacket(i);
+        }
+        fake::sentRawHID().clear();
+        return iconTransfers.isReceiving() ? "not complete" : checkReceivedIcon(defaultIconPixels());
+    }
+
+    struct IconStream {
+        std::string name;
+        std::vector<uint8_t> compressed;
+    };
+
+    IconStream compressIcon(const char *name, const int level, const uint16_t *pixels) {
+        IconStream stream{name, std::vector<uint8_t>(ICON_SIZE * ICON_SIZE * 2 * 21 / 20 + 66)};
+        stream.compressed.resize(fastlz_compress_level(level, pixels, ICON_SIZE * ICON_SIZE * 2,
+                                                       stream.compressed.data()));
+        return stream;
+    }
+
+    bool loadIconStream(const char *path, IconStream &stream) {
+        FILE *file = fopen(path, "rb");
+        if (file == nullptr) {
+            return false;
+        }
+        uint8_t buffer[4096];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            stream.compressed.insert(stream.compressed.end(), buffer, buffer + read);
+        }
+        fclose(file);
+        stream.name = path;
+        return true;
+    }
+
+    std::vector<IconStream> iconStreams(const int argc, char **argv) {
+        // a smooth gradient and noise bracket the flat, mostly black real icons
+        static uint16_t gradient[ICON_SIZE][ICON_SIZE];
+        static uint16_t noise[ICON_SIZE][ICON_SIZE];
+        uint32_t seed = 1;
+        for (uint8_t y = 0; y < ICON_SIZE; y++) {
+            for (uint8_t x = 0; x < ICON_SIZE; x++) {
+                gradient[y][x] = static_cast<uint16_t>((x >> 2) << 11 | (y >> 1) << 5 | ((x + y) >> 3));
+                seed = seed * 1103515245 + 12345;
+                noise[y][x] = static_cast<uint16_t>(seed >> 16);
+            }
+        }
+        std::vector<IconStream> streams = {
+            compressIcon("default icon, level 1", 1, defaultIconPixels()),
+            compressIcon("default icon, level 2", 2, defaultIconPixels()),
+            compressIcon("gradient, level 1", 1, &gradient[0][0]),
+            compressIcon("noise, level 1", 1, &noise[0][0]),
+        };
+        for (int i = 2; i < argc; i++) {
+            IconStream stream;
+            if (loadIconStream(argv[i], stream)) {
+                streams.push_back(stream);
+            } else {
+                printf("cannot read %s\n", argv[i]);
+            }
+        }
+        return streams;
+    }
+
+    // whole-buffer fastlz_decompress() after the last packet against FastLZStream fed one packet at a time, false
+    // if any stream decoded differently
+    bool replayIconStreams(const std::vector<IconStream> &streams) {
+        constexpr uint32_t RUNS = 200;
+        constexpr uint8_t PAYLOAD = PacketPositions::IconPacket::NUM_ICON_BYTES_SENT;
+        static uint8_t reference[ICON_SIZE * ICON_SIZE * 2];
+        static uint8_t streamed[ICON_SIZE * ICON_SIZE * 2];
+        printf("\n%-28s %7s %7s %12s %12s %12s\n", "icon stream", "bytes", "packets", "whole us",
+               "packet max", "last packet");
+        bool ok = true;
+        for (const auto &stream: streams) {
+            const uint32_t length = stream.compressed.size();
+            const uint32_t packets = (length + PAYLOAD - 1) / PAYLOAD;
+            std::vector<uint8_t> padded(packets * PAYLOAD);
+            memcpy(padded.data(), stream.compressed.data(), length);
+            uint64_t wholeNanos = 0;
+            uint64_t packetMaxNanos = 0;
+            uint64_t lastNanos = 0;
+            bool matches = true;
+            for (uint32_t run = 0; run < RUNS; run++) {
+                auto start = Clock::now();
+                const int decompressed = fastlz_decompress(stream.compressed.data(), static_cast<int>(length),
+                                                           reference, sizeof(reference));
+                wholeNanos += nanosSince(start);
+
+                FastLZStream decoder;
+                decoder.begin(streamed, sizeof(streamed), length);
+                for (uint32_t packet = 0; packet < packets; packet++) {
+                    start = Clock::now();
+                    decoder.feed(&padded[packet * PAYLOAD], PAYLOAD);
+                    const uint64_t nanos = nanosSince(start);
+                    packetMaxNanos = max(packetMaxNanos, nanos);
+                    if (packet == packets - 1) {
+                        lastNanos += nanos;
+                    }
+                }
+                matches &= decompressed == sizeof(reference) &&
+                        decoder.getStatus() == FastLZStream::Status::DONE &&
+                        memcmp(reference, streamed, sizeof(reference)) == 0;
+            }
+            printf("%-28.28s %7" PRIu32 " %7" PRIu32 " %12.2f %12.2f %12.2f%s\n", stream.name.c_str(), length,
+                   packets, wholeNanos / 1000.0 / RUNS, packetMaxNanos / 1000.0, lastNanos / 1000.0 / RUNS,
+                   matches ? "" : "  MISMATCH");
+            ok &= matches;
+        }
+        printf("staging: %zu B decoder state instead of a %u B compression buffer\n", sizeof(FastLZStream),
+               ICON_SIZE * ICON_SIZE * 2 * 21 / 20 + 66);
+        return ok;
+    }
+
+    // refreshing a retained channel sends its last frame again as it is, without rendering into the buffer
+    const char *checkRefresh() {
+        constexpr uint8_t CHANNEL = 1;
+        if (!frameBufferPool.isRetained()) {
+            return "frame buffers not retained";
+        }
+        // let the scheduler work off what the earlier checks left for the panels
+        const auto pending = [] {
+            return displayScheduler.isBusy() || std::any_of(std::begin(faderChannels), std::end(faderChannels),
+                                                            [](const FaderChannel &channel) {
+                                                                return channel.hasScreenChanges();
+                                                            });
+        };
+        for (int i = 0; i < 100000 && pending(); i++) {
+            step();
+        }
+        if (pending()) {
+            return "screens never settled";
+        }
+        const uint16_t *buffer = frameBufferPool.get(CHANNEL);
+        const std::vector<uint16_t> before(buffer, buffer + SCREEN_WIDTH * SCREEN_HEIGHT);
+        const fake::DisplayStats sentBefore = fake::getDisplayStats();
+        displayScheduler.refresh(CHANNEL);
+        displayScheduler.update();
+        displayScheduler.waitIdle();
+        const fake::DisplayStats sentAfter = fake::getDisplayStats();
+        if (sentAfter.fullFrames + sentAfter.asyncFrames != sentBefore.fullFrames + sentBefore.asyncFrames + 1) {
+            return "no full frame sent";
+        }
+        if (sentAfter.windows != sentBefore.windows) {
+            return "sent partial updates";
+        }
+        return std::equal(before.begin(), before.end(), buffer) ? "ok" : "rendered into the buffer";
+    }
+
+    // two CHANNEL_DATA in one report are handled in order, the channel ends up with the second name
+    const char *checkMultiMessage(Timing &timing) {
+        using namespace PacketPositions;
+        Packet report(MULTI_MESSAGE);
+        uint8_t offset = MultiMessage::FIRST_MESSAGE_INDEX;
+        for (const char *name: {"first message", "second message"}) {
+            Packet message(CHANNEL_DATA);
+            message.put<uint8_t>(ChannelData::MAX_VOLUME_INDEX, 50);
+            message.put<uint32_t>(ChannelData::PID_INDEX, FIRST_PID);
+            message.putName(ChannelData::NAME_INDEX, name);
+            constexpr uint8_t length = ChannelData::NAME_INDEX + NAME_LENGTH_MAX - Base::STATUS_INDEX;
+            report.data[offset] = length;
+            memcpy(&report.data[offset + MultiMessage::LENGTH_SIZE], &message.data[Base::STATUS_INDEX], length);
+            offset += MultiMessage::LENGTH_SIZE + length;
+        }
+        deliver(report, timing);
+        for (const auto &channel: faderChannels) {
+            if (channel.appdata.PID == FIRST_PID) {
+                return strcmp(channel.appdata.name, "second message") == 0 ? "ok" : "wrong order";
+            }
+        }
+        return "no channel";
+    }
+
+    // closing and reopening a process whose icon was shown before should be answered from the icon cache
+    uint32_t reopenProcess(Timing &timing) {
+        Packet closed(PID_CLOSED);
+        closed.put<uint32_t>(PacketPositions::PIDClosed::PID_INDEX, FIRST_PID);
+        deliver(closed, timing);
+        Packet opened(NEW_PID);
+        opened.put<uint32_t>(PacketPositions::NewPID::PID_INDEX, FIRST_PID);
+        opened.putName(PacketPositions::NewPID::NAME_INDEX, "bench process");
+        opened.put<uint8_t>(PacketPositions::NewPID::VOL_INDEX, 50);
+        deliver(opened, timing);
+        uint32_t iconRequests = 0;
+        for (const auto &message: sentMessages()) {
+            iconRequests += message[PacketPositions::Base::STATUS_INDEX] == REQUEST_ICON;
+        }
+        return iconRequests;
+    }
+}
+
+int main(const int argc, char **argv) {
+    const uint32_t idleLoops = argc > 1 ? strtoul(argv[1], nullptr, 10) : DEFAULT_IDLE_LOOPS;
+    fake::setAdcSource([](uint8_t) { return static_cast<uint16_t>(512); });
+
+    const auto bootStart = Clock::now();
+    setup();
+    printf("setup() %.1f ms host, %.1f ms simulated\n", nanosSince(bootStart) / 1e6,
+           fake::nowCycles() / (fake::CYCLES_PER_MICRO * 1000.0));
+
+    Timing startup{"process list"};
+    fake::sentRawHID().clear();
+    answerProcessRequest(startup);
+    const size_t startupReports = fake::sentRawHID().size();
+    const size_t startupMessages = sentMessages().size();
+    printf("startup: %zu messages in %zu reports\n", startupMessages, startupReports);
+
+    Timing idle{"idle loop()"};
+    const auto idleStart = Clock::now();
+    for (uint32_t i = 0; i < idleLoops; i++) {
+        step();
+    }
+    idle.count = idleLoops;
+    idle.totalNanos = nanosSince(idleStart);
+    printf("idle: %.0f loop()/s\n", idleLoops / (idle.totalNanos / 1e9));
+
+    Timing volume{"volume levels"};
+    Timing channel{"channel data"};
+    for (uint32_t i = 0; i < 10000; i++) {
+        sendVolumeLevels(i % 100, volume);
+        if (i % 10 == 0) {
+            sendChannelData(i % 100, channel);
+        }
+        fake::sentRawHID().clear();
+    }
+
+    static uint8_t compressed[ICON_SIZE * ICON_SIZE * 2 * 21 / 20 + 66];
+    const int length = fastlz_compress_level(1, defaultIconPixels(), IconStore::ICON_BYTES, compressed);
+    Timing iconPacket{"icon packet"};
+    Timing icon{"icon transfer"};
+    for (int i = 0; i < 50; i++) {
+        sendIcon(compressed, length, ICON_CODEC_FASTLZ, iconPacket, icon);
+        fake::sentRawHID().clear();
+    }
+    const char *fastlzCheck = checkReceivedIcon(defaultIconPixels());
+
+    static uint8_t rleCompressed[IconRLE::MAX_COMPRESSED];
+    const uint32_t rleLength = IconRLE::compress(defaultIconPixels(), rleCompressed);
+    Timing rlePacket{"IconRLE icon packet"};
+    Timing rleIcon{"IconRLE icon transfer"};
+    for (int i = 0; i < 50; i++) {
+        sendIcon(rleCompressed, rleLength, ICON_CODEC_RLE, rlePacket, rleIcon);
+        fake::sentRawHID().clear();
+    }
+    const char *rleCheck = checkReceivedIcon(defaultIconPixels());
+
+    Timing builtinDraw{"built-in icon from flash"};
+    Timing slotDraw{"icon from a slot"};
+    const char *builtinCheck = checkBuiltinDraw(builtinDraw, slotDraw);
+    Timing pixelDraw{"icon, drawPixel() loop"};
+    Timing rectDraw{"icon, writeRect()"};
+    const char *iconDrawCheck = checkIconDraw(pixelDraw, rectDraw);
+
+    Timing reopen{"reopen process"};
+    const uint32_t hitsBeforeReopen = iconCache.getStats().hits;
+    uint32_t iconRequests = 0;
+    for (uint32_t i = 0; i < REOPENS; i++) {
+        iconRequests += reopenProcess(reopen);
+    }
+    // switching back to a recent program has to be answered from the cache alone
+    const bool reopenOk = iconRequests == 0 && iconCache.getStats().hits - hitsBeforeReopen >= REOPENS;
+    Timing multiMessage{"multi message"};
+    const char *multiMessageCheck = checkMultiMessage(multiMessage);
+    const char *refreshCheck = checkRefresh();
+
+    const fake::DisplayStats display = fake::getDisplayStats();
+    printf("\nhost latency per packet\n");
+    for (const Timing *timing: {
+             &startup, &volume, &channel, &iconPacket, &icon, &rlePacket, &rleIcon, &reopen
+         }) {
+        timing->print();
+    }
+    printf("\nicon drawing, %s\n", builtinCheck);
+    builtinDraw.print();
+    slotDraw.print();
+    printf("per-pixel against row-wise drawing, %s\n", iconDrawCheck);
+    pixelDraw.print();
+    rectDraw.print();
+    printf("\ndisplay: %" PRIu64 " pixels sent, %" PRIu32 " full frames (%" PRIu32 " async), %" PRIu32
+           " windows\n", display.pixelsSent, display.fullFrames + display.asyncFrames, display.asyncFrames,
+           display.windows);
+    printf("received icon: fastlz %s, IconRLE %s\n", fastlzCheck, rleCheck);
+    printf("multi message: %s\n", multiMessageCheck);
+    printf("retained frame refresh: %s\n", refreshCheck);
+    const IconCache::Stats cache = iconCache.getStats();
+    printf("icon cache: %" PRIu32 " hits, %" PRIu32 " misses, %" PRIu32 " icon requests sent on reopen%s\n",
+           cache.hits, cache.misses, iconRequests, reopenOk ? "" : "  FAILED");
+
+    const std::vector<IconStream> streams = iconStreams(argc, argv);
+    printf("\nlink: %" PRIu32 " us per packet, %" PRIu32 " us host turnaround, firmware window %u\n",
+           LINK_PACKET_MICROS, HOST_TURNAROUND_MICROS, IconTransfers::WINDOW);
+    bool throughputOk = printThroughput(streams[0].name.c_str(), streams[0].compressed);
+    throughputOk &= printThroughput(streams[2].name.c_str(), streams[2].compressed);
+    const char *lostPacketCheck = checkLostPacket(streams[0].compressed);
+    printf("lost packet resent: %s\n", lostPacketCheck);
+    const bool replayOk = replayIconStreams(streams);
+
+    bool passed = throughputOk && replayOk && reopenOk;
+    for (const char *check: {
+             builtinCheck, iconDrawCheck, fastlzCheck, rleCheck, multiMessageCheck, refreshCheck, lostPacketCheck
+         }) {
+        passed &= strcmp(check, "ok") == 0;
+    }
+    return passed ? 0 : 1;
+}
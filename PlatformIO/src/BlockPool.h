@@ -0,0 +1,98 @@
+#pragma once
+
+#include <Arduino.h>
+#include "MemoryArena.h"
+
+/**
+ * @brief A fixed number of same sized buffers of T[ELEMENTS] taken from a MemoryArena in one allocation
+ *
+ * begin() asks for as many blocks as wanted and settles for fewer down to a minimum, so a pool sized for PSRAM
+ * still comes up smaller elsewhere. Blocks are addressed by index, acquire() hands out a free one and keeps the
+ * high-water mark of blocks in use.
+ */
+template <typename T, size_t ELEMENTS>
+class BlockPool {
+public:
+    static constexpr size_t BLOCK_BYTES = ELEMENTS * sizeof(T);
+    static constexpr uint8_t MAX_BLOCKS = 32;
+    static constexpr uint8_t NO_BLOCK = UINT8_MAX;
+
+    BlockPool() = default;
+
+    ~BlockPool() = default;
+
+    /// Returns the number of blocks allocated, 0 if not even minimum fit
+    uint8_t begin(MemoryArena *_arena, uint8_t wanted, const uint8_t minimum, const char *owner) {
+        end();
+        wanted = min(wanted, MAX_BLOCKS);
+        for (uint8_t count = wanted; count >= max(minimum, static_cast<uint8_t>(1)); count--) {
+            blocks = static_cast<T *>(_arena->allocate(count * BLOCK_BYTES, owner));
+            if (blocks != nullptr) {
+                arena = _arena;
+                blockCount = count;
+                break;
+            }
+        }
+        return blockCount;
+    }
+
+    void end() {
+        if (arena != nullptr) {
+            arena->release(blocks);
+        }
+        arena = nullptr;
+        blocks = nullptr;
+        blockCount = 0;
+        used = 0;
+        highWater = 0;
+    }
+
+    [[nodiscard]] T *get(const uint8_t index) const {
+        return index < blockCount ? blocks + index * ELEMENTS : nullptr;
+    }
+
+    /// A free block marked as in use, NO_BLOCK if there is none
+    [[nodiscard]] uint8_t acquire() {
+        for (uint8_t index = 0; index < blockCount; index++) {
+            if (!isInUse(index)) {
+                used |= 1ul << index;
+                highWater = max(highWater, getInUse());
+                return index;
+            }
+        }
+        return NO_BLOCK;
+    }
+
+    void release(const uint8_t index) {
+        if (index < blockCount) {
+            used &= ~(1ul << index);
+        }
+    }
+
+    [[nodiscard]] bool isInUse(const uint8_t index) const {
+        return index < blockCount && (used >> index & 1) != 0;
+    }
+
+    [[nodiscard]] uint8_t getCount() const {
+        return blockCount;
+    }
+
+    [[nodiscard]] uint8_t getInUse() const {
+        return __builtin_popcount(used);
+    }
+
+    [[nodiscard]] uint8_t getHighWater() const {
+        return highWater;
+    }
+
+    [[nodiscard]] const MemoryArena *getArena() const {
+        return arena;
+    }
+
+private:
+    MemoryArena *arena = nullptr;
+    T *blocks = nullptr;
+    uint32_t used = 0;
+    uint8_t blockCount = 0;
+    uint8_t highWater = 0;
+};
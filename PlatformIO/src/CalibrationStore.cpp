@@ -0,0 +1,42 @@
+#include "CalibrationStore.h"
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "Crc32.h"
+
+
+bool CalibrationStore::load(Calibration &calibration) const {
+    Record record{};
+    EEPROM.get(EEPROM_ADDRESS, record);
+    if (record.magic != MAGIC || record.version != VERSION || record.channelCount != CHANNELS ||
+        record.crc != checksum(record)) {
+        return false;
+    }
+    for (const auto &channel: record.channels) {
+        if (channel.positionMax <= channel.positionMin ||
+            channel.positionMax - channel.positionMin < MIN_POSITION_RANGE) {
+            return false;
+        }
+    }
+    memcpy(calibration, record.channels, sizeof(record.channels));
+    return true;
+}
+
+void CalibrationStore::save(const Calibration &calibration) const {
+    Record record{};
+    record.magic = MAGIC;
+    record.version = VERSION;
+    record.channelCount = CHANNELS;
+    memcpy(record.channels, calibration, sizeof(record.channels));
+    record.crc = checksum(record);
+    // put() only rewrites bytes that changed, so saving the same calibration does not wear the flash
+    EEPROM.put(EEPROM_ADDRESS, record);
+}
+
+void CalibrationStore::invalidate() const {
+    EEPROM.update(EEPROM_ADDRESS, 0);
+}
+
+// CRC-32 over everything in front of the crc field
+uint32_t CalibrationStore::checksum(const Record &record) {
+    return ~crc32Update(0xFFFFFFFF, &record, offsetof(Record, crc));
+}
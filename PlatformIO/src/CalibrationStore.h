@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Globals.h"
+
+struct ChannelCalibration {
+    uint16_t positionMin = 100;
+    uint16_t positionMax = 950;
+    uint32_t touchBaseline = 0;
+    float touchSensitivity = 1.5f;
+};
+
+/**
+ * @brief Fader calibration persisted in the Teensy EEPROM emulation
+ *
+ * Memory layout (at EEPROM_ADDRESS):
+ * [MAGIC 4B][VERSION 1B][CHANNELS 1B][RESERVED 2B][ChannelCalibration x CHANNELS][CRC32 4B]
+ *
+ * A record is only accepted when the magic, version, channel count and CRC all match and every channel has a
+ * plausible pot range, so a blank or half-written EEPROM just means "calibrate".
+ */
+class CalibrationStore {
+public:
+    using Calibration = ChannelCalibration[CHANNELS];
+
+    /// Smallest pot travel (raw counts) accepted as a real end stop to end stop sweep
+    static constexpr uint16_t MIN_POSITION_RANGE = 300;
+
+    CalibrationStore() = default;
+
+    ~CalibrationStore() = default;
+
+    [[nodiscard]] bool load(Calibration &calibration) const;
+
+    void save(const Calibration &calibration) const;
+
+    void invalidate() const;
+
+private:
+    static constexpr uint32_t MAGIC = 0x41434246; // "FBCA"
+    static constexpr uint8_t VERSION = 1;
+    static constexpr int EEPROM_ADDRESS = 0;
+
+    struct Record {
+        uint32_t magic;
+        uint8_t version;
+        uint8_t channelCount;
+        uint16_t reserved;
+        ChannelCalibration channels[CHANNELS];
+        uint32_t crc;
+    };
+
+    static uint32_t checksum(const Record &record);
+};
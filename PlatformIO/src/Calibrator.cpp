@@ -0,0 +1,121 @@
+#include "Calibrator.h"
+#include <Arduino.h>
+#include "CalibrationStore.h"
+
+
+Calibrator::Calibrator(FaderChannel *_channels, FaderServo *_servo) {
+    channels = _channels;
+    servo = _servo;
+}
+
+void Calibrator::start(const uint32_t nowMillis) {
+    startedAt = nowMillis;
+    running = true;
+    for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+        channels[channel].setCalibrating(true);
+        servo->setEnabled(channel, false);
+        states[channel].result = Result::PENDING;
+        enterPhase(states[channel], Phase::RELEASE_SERVO, nowMillis, servo->getRawPosition(channel));
+    }
+}
+
+bool Calibrator::update(const uint32_t nowMillis) {
+    if (!running) {
+        return false;
+    }
+    bool active = false;
+    for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+        ChannelState &state = states[channel];
+        if (state.phase == Phase::DONE) {
+            continue;
+        }
+        active = true;
+        const FaderMotor *motor = channels[channel].motor;
+        const uint16_t raw = servo->getRawPosition(channel);
+        if (abs(raw - state.anchor) > STALL_COUNTS) {
+            state.anchor = raw;
+            state.lastMove = nowMillis;
+        }
+        const uint32_t inPhase = nowMillis - state.phaseStart;
+        const bool stalled = inPhase >= SPIN_UP_MILLIS && nowMillis - state.lastMove >= STALL_MILLIS;
+
+        switch (state.phase) {
+            case Phase::RELEASE_SERVO:
+                if (inPhase >= SERVO_RELEASE_MILLIS) {
+                    motor->forward(DRIVE_SPEED);
+                    enterPhase(state, Phase::TO_MAX, nowMillis, raw);
+                }
+                break;
+            case Phase::TO_MAX:
+                if (stalled) {
+                    state.positionMax = raw;
+                    motor->backward(DRIVE_SPEED);
+                    enterPhase(state, Phase::TO_MIN, nowMillis, raw);
+                } else if (inPhase >= PHASE_TIMEOUT_MILLIS) {
+                    finish(channel, Result::NO_END_STOP, nowMillis);
+                }
+                break;
+            case Phase::TO_MIN:
+                if (stalled) {
+                    state.positionMin = raw;
+                    if (state.positionMax <= state.positionMin ||
+                        state.positionMax - state.positionMin < CalibrationStore::MIN_POSITION_RANGE) {
+                        finish(channel, Result::NO_TRAVEL, nowMillis);
+                    } else {
+                        motor->forward(NUDGE_SPEED);
+                        enterPhase(state, Phase::NUDGE, nowMillis, raw);
+                    }
+                } else if (inPhase >= PHASE_TIMEOUT_MILLIS) {
+                    finish(channel, Result::NO_END_STOP, nowMillis);
+                }
+                break;
+            case Phase::NUDGE:
+                if (inPhase >= NUDGE_MILLIS) {
+                    channels[channel].setPositionRange(state.positionMin, state.positionMax);
+                    finish(channel, Result::OK, nowMillis);
+                }
+                break;
+            case Phase::DONE:
+                break;
+        }
+    }
+    running = active;
+    return running;
+}
+
+bool Calibrator::isRunning() const {
+    return running;
+}
+
+bool Calibrator::succeeded() const {
+    for (const auto &state: states) {
+        if (state.result != Result::OK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Calibrator::Result Calibrator::getResult(const uint8_t channel) const {
+    return states[channel].result;
+}
+
+uint32_t Calibrator::getDuration(const uint8_t channel) const {
+    return states[channel].finishedAt - startedAt;
+}
+
+void Calibrator::enterPhase(ChannelState &state, const Phase phase, const uint32_t nowMillis,
+                            const uint16_t raw) const {
+    state.phase = phase;
+    state.phaseStart = nowMillis;
+    state.lastMove = nowMillis;
+    state.anchor = raw;
+}
+
+void Calibrator::finish(const uint8_t channel, const Result result, const uint32_t nowMillis) {
+    channels[channel].motor->stop();
+    channels[channel].setCalibrating(false);
+    states[channel].phase = Phase::DONE;
+    states[channel].result = result;
+    states[channel].finishedAt = nowMillis;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Globals.h"
+#include "FaderChannel.h"
+#include "FaderServo.h"
+
+/**
+ * @brief Non-blocking end stop calibration of all faders at once
+ *
+ * Every channel runs its own sequence (up to the top stop, down to the bottom stop, short nudge off the stop)
+ * and moves on as soon as its pot reading stops changing instead of waiting a fixed worst case time. A phase
+ * that never stalls, or a sweep that covers too little travel, marks the channel as failed and leaves its
+ * previous range in place.
+ *
+ * update() does one step and returns whether anything is still running, so it can be driven from init() or
+ * from loop() while the rest of the firmware keeps going.
+ */
+class Calibrator {
+public:
+    enum class Result : uint8_t {
+        PENDING,
+        OK,
+        NO_END_STOP,
+        NO_TRAVEL,
+    };
+
+    Calibrator(FaderChannel *_channels, FaderServo *_servo);
+
+    ~Calibrator() = default;
+
+    void start(uint32_t nowMillis);
+
+    bool update(uint32_t nowMillis);
+
+    [[nodiscard]] bool isRunning() const;
+
+    [[nodiscard]] bool succeeded() const;
+
+    [[nodiscard]] Result getResult(uint8_t channel) const;
+
+    /// Time the channel took from start to finish
+    [[nodiscard]] uint32_t getDuration(uint8_t channel) const;
+
+private:
+    enum class Phase : uint8_t {
+        RELEASE_SERVO,
+        TO_MAX,
+        TO_MIN,
+        NUDGE,
+        DONE,
+    };
+
+    struct ChannelState {
+        Phase phase = Phase::DONE;
+        Result result = Result::PENDING;
+        uint32_t phaseStart = 0;
+        uint32_t lastMove = 0;
+        uint16_t anchor = 0;
+        uint16_t positionMax = 0;
+        uint16_t positionMin = 0;
+        uint32_t finishedAt = 0;
+    };
+
+    static constexpr uint8_t DRIVE_SPEED = 65;
+    static constexpr uint8_t NUDGE_SPEED = 80;
+    /// Lets the servo timer see the channel disabled before the calibration drives the motor
+    static constexpr uint32_t SERVO_RELEASE_MILLIS = 3;
+    /// Movement smaller than this (raw counts) does not count as moving
+    static constexpr uint16_t STALL_COUNTS = 4;
+    /// How long the reading has to stay put to count as stalled at the end stop
+    static constexpr uint32_t STALL_MILLIS = 60;
+    /// Ignore the first part of each drive while the motor spins up
+    static constexpr uint32_t SPIN_UP_MILLIS = 40;
+    static constexpr uint32_t PHASE_TIMEOUT_MILLIS = 1500;
+    static constexpr uint32_t NUDGE_MILLIS = 50;
+
+    FaderChannel *channels;
+    FaderServo *servo;
+    ChannelState states[CHANNELS];
+    uint32_t startedAt = 0;
+    bool running = false;
+
+    void enterPhase(ChannelState &state, Phase phase, uint32_t nowMillis, uint16_t raw) const;
+
+    void finish(uint8_t channel, Result result, uint32_t nowMillis);
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <Arduino.h>
+
+/// CRC-32 (IEEE, same as zlib). Start with 0xFFFFFFFF, feed the data in any number of pieces, invert at the end.
+inline uint32_t crc32Update(uint32_t crc, const void *data, const size_t length) {
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,62 @@
+#include "DecodeBenchmark.h"
+#include <Arduino.h>
+#include "FastLZStream.h"
+#include "Globals.h"
+#include "packets/PacketPositions.h"
+#include "thirdparty/fastlz.h"
+
+namespace {
+    constexpr uint32_t ICON_BYTES = ICON_SIZE * ICON_SIZE * sizeof(uint16_t);
+    constexpr uint32_t COMPRESSED_MAX = ICON_BYTES * 21 / 20 + 66; // 5% larger than input + 66 bytes
+    constexpr uint8_t PAYLOAD = PacketPositions::IconPacket::NUM_ICON_BYTES_SENT;
+}
+
+DecodeCycles measureFastLZDecode(const uint16_t *icon, const CycleCounter cycles, const uint8_t runs,
+                                 MemoryArena *scratch) {
+    DecodeCycles result{};
+    auto *compressed = static_cast<uint8_t *>(scratch->allocate(COMPRESSED_MAX, "benchmark input"));
+    auto *portable = static_cast<uint8_t *>(scratch->allocate(ICON_BYTES, "benchmark output"));
+    auto *streamed = static_cast<uint8_t *>(scratch->allocate(ICON_BYTES, "benchmark output"));
+    if (compressed == nullptr || portable == nullptr || streamed == nullptr) {
+        scratch->release(compressed);
+        scratch->release(portable);
+        scratch->release(streamed);
+        return result;
+    }
+    result.compressedBytes = fastlz_compress_level(1, icon, ICON_BYTES, compressed);
+
+    uint64_t portableTotal = 0;
+    uint64_t streamTotal = 0;
+    for (uint8_t run = 0; run < runs; run++) {
+        uint32_t start = cycles();
+        fastlz_decompress(compressed, static_cast<int>(result.compressedBytes), portable, ICON_BYTES);
+        portableTotal += cycles() - start;
+
+        FastLZStream decoder;
+        start = cycles();
+        decoder.begin(streamed, ICON_BYTES, result.compressedBytes);
+        for (uint32_t offset = 0; offset < result.compressedBytes; offset += PAYLOAD) {
+            decoder.feed(compressed + offset, PAYLOAD);
+        }
+        streamTotal += cycles() - start;
+        result.identical = decoder.getStatus() == FastLZStream::Status::DONE &&
+                           memcmp(portable, streamed, ICON_BYTES) == 0 && memcmp(portable, icon, ICON_BYTES) == 0;
+    }
+    result.portableCycles = portableTotal / runs;
+    result.streamCycles = streamTotal / runs;
+    scratch->release(compressed);
+    scratch->release(portable);
+    scratch->release(streamed);
+    return result;
+}
+
+void printDecodeCycles(Print &out, const char *name, const DecodeCycles &result) {
+    if (result.compressedBytes == 0) {
+        out.printf("%-28.28s no memory for the benchmark\n", name);
+        return;
+    }
+    out.printf("%-28.28s %6lu B  fastlz_decompress %6.2f cycles/B  FastLZStream %6.2f cycles/B%s\n", name,
+               static_cast<unsigned long>(result.compressedBytes),
+               static_cast<double>(result.portableCycles) / ICON_BYTES,
+               static_cast<double>(result.streamCycles) / ICON_BYTES, result.identical ? "" : "  MISMATCH");
+}
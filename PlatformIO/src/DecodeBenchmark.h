@@ -0,0 +1,27 @@
+#pragma once
+
+#include <Arduino.h>
+#include "MemoryArena.h"
+
+/**
+ * @brief Cycles the FastLZ decoders need for one icon
+ *
+ * Compresses the icon with FastLZ level 1 like the computer does, then decodes it with the portable
+ * fastlz_decompress() in one go and with FastLZStream fed one ICON_PACKET payload at a time, and checks both
+ * produce the same bytes. Runs on the board from the serial console (DWT cycle counter) and in the codec env on
+ * the host (time stamp counter), so both report cycles per decompressed byte for the same icons.
+ */
+struct DecodeCycles {
+    uint32_t compressedBytes;
+    /// Average cycles per icon
+    uint32_t portableCycles;
+    uint32_t streamCycles;
+    bool identical;
+};
+
+using CycleCounter = uint32_t (*)();
+
+/// Takes its three buffers from scratch for the duration of the call, returns all zeros if they do not fit
+DecodeCycles measureFastLZDecode(const uint16_t *icon, CycleCounter cycles, uint8_t runs, MemoryArena *scratch);
+
+void printDecodeCycles(Print &out, const char *name, const DecodeCycles &result);
@@ -0,0 +1,30 @@
+#include "DirtyRegions.h"
+#include <Arduino.h>
+
+
+void DirtyRegions::mark(const uint8_t region) {
+    if (region < MAX_REGIONS) {
+        regions |= 1UL << region;
+    }
+}
+
+void DirtyRegions::markAll() {
+    full = true;
+}
+
+void DirtyRegions::clear() {
+    regions = 0;
+    full = false;
+}
+
+bool DirtyRegions::any() const {
+    return full || regions != 0;
+}
+
+bool DirtyRegions::isFull() const {
+    return full;
+}
+
+bool DirtyRegions::isDirty(const uint8_t region) const {
+    return full || (region < MAX_REGIONS && (regions & (1UL << region)) != 0);
+}
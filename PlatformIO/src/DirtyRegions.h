@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Records which parts of a screen changed since it was last sent to the panel
+ *
+ * Regions are small integer ids chosen by the owner, which also knows where each one sits on screen.
+ * markAll() stands for "everything, including whatever is not covered by a region" and means a full redraw.
+ */
+class DirtyRegions {
+public:
+    static constexpr uint8_t MAX_REGIONS = 32;
+
+    DirtyRegions() = default;
+
+    ~DirtyRegions() = default;
+
+    void mark(uint8_t region);
+
+    void markAll();
+
+    void clear();
+
+    [[nodiscard]] bool any() const;
+
+    [[nodiscard]] bool isFull() const;
+
+    [[nodiscard]] bool isDirty(uint8_t region) const;
+
+private:
+    uint32_t regions = 0;
+    bool full = false;
+};
@@ -0,0 +1,102 @@
+#include "DisplayScheduler.h"
+#include <Arduino.h>
+#include "MuxManager.h"
+#include "Profiler.h"
+
+
+DisplayScheduler::DisplayScheduler(TFTPanel *_tft, FaderChannel *_channels, FrameBufferPool *_pool) {
+    tft = _tft;
+    channels = _channels;
+    pool = _pool;
+}
+
+void DisplayScheduler::update() {
+    if (transferring) {
+        if (tft->asyncUpdateActive()) {
+            return;
+        }
+        finishTransfer();
+    }
+    for (uint8_t i = 0; i < CHANNELS; i++) {
+        const uint8_t channel = (nextChannel + i) % CHANNELS;
+        const bool refresh = refreshPending & (1 << channel);
+        if (!refresh && !channels[channel].hasScreenChanges()) {
+            continue;
+        }
+        nextChannel = (channel + 1) % CHANNELS;
+        refreshPending &= ~(1 << channel);
+        selectChannel(channel);
+        ProfileScope profile(Profiler::UPDATE_SCREEN);
+        const uint32_t start = micros();
+        if (channels[channel].renderScreen() || refresh) {
+            startFrame();
+        } else {
+            stats.partialUpdates++;
+            stats.lastPartialMicros = micros() - start;
+            stats.maxPartialMicros = max(stats.maxPartialMicros, stats.lastPartialMicros);
+        }
+        return;
+    }
+}
+
+void DisplayScheduler::refresh(const uint8_t channel) {
+    if (pool->isRetained()) {
+        refreshPending |= 1 << channel;
+    } else {
+        // the shared buffer holds whichever channel drew last
+        channels[channel].updateScreen = true;
+    }
+}
+
+bool DisplayScheduler::isBusy() const {
+    return transferring;
+}
+
+void DisplayScheduler::waitIdle() {
+    if (transferring) {
+        tft->waitUpdateAsyncComplete();
+        finishTransfer();
+    }
+}
+
+DisplayScheduler::Stats DisplayScheduler::getStats() const {
+    return stats;
+}
+
+void DisplayScheduler::resetStats() {
+    stats = {};
+}
+
+void DisplayScheduler::printStats(Print &out) const {
+    out.printf("display frames %lu last %lu us max %lu us, partial updates %lu last %lu us max %lu us\n",
+               static_cast<unsigned long>(stats.frames), static_cast<unsigned long>(stats.lastFrameMicros),
+               static_cast<unsigned long>(stats.maxFrameMicros), static_cast<unsigned long>(stats.partialUpdates),
+               static_cast<unsigned long>(stats.lastPartialMicros),
+               static_cast<unsigned long>(stats.maxPartialMicros));
+}
+
+void DisplayScheduler::selectChannel(const uint8_t channel) const {
+    muxManager.select(MuxManager::CS, channel);
+    if (uint16_t *buffer = pool->get(channel); buffer != nullptr) {
+        tft->setFrameBuffer(buffer);
+    }
+    muxManager.waitSettled(MuxManager::CS);
+}
+
+void DisplayScheduler::startFrame() {
+    transferStart = micros();
+    if (tft->updateScreenAsync()) {
+        transferring = true;
+    } else {
+        // no DMA available, the frame still has to go out
+        tft->updateScreen();
+        finishTransfer();
+    }
+}
+
+void DisplayScheduler::finishTransfer() {
+    transferring = false;
+    stats.frames++;
+    stats.lastFrameMicros = micros() - transferStart;
+    stats.maxFrameMicros = max(stats.maxFrameMicros, stats.lastFrameMicros);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Globals.h"
+#include "TFTPanel.h"
+#include "FaderChannel.h"
+#include "FrameBufferPool.h"
+
+/**
+ * @brief Streams the channel screens out one at a time without blocking loop()
+ *
+ * All eight panels hang off one SPI bus and one tft object, with the CS mux picking which panel listens. The
+ * scheduler is the only thing that switches that mux: it picks the next channel with pending screen changes
+ * (round robin, so one busy channel cannot starve the rest), lets it render, and either sends the changed
+ * regions right away (a few KB) or starts an asynchronous DMA transfer for a full frame. While a frame is in
+ * flight update() returns immediately, so the CS mux and the frame buffer stay untouched until the DMA is done.
+ *
+ * Before a channel renders, the tft is pointed at that channel's buffer from the FrameBufferPool, so with
+ * retained buffers a channel only ever draws what changed on its own screen.
+ */
+class DisplayScheduler {
+public:
+    struct Stats {
+        uint32_t frames;
+        uint32_t partialUpdates;
+        /// DMA time of full frames, from start until the completion was seen
+        uint32_t lastFrameMicros;
+        uint32_t maxFrameMicros;
+        /// Render plus send time of partial updates
+        uint32_t lastPartialMicros;
+        uint32_t maxPartialMicros;
+    };
+
+    DisplayScheduler(TFTPanel *_tft, FaderChannel *_channels, FrameBufferPool *_pool);
+
+    ~DisplayScheduler() = default;
+
+    void update();
+
+    /// Sends the channel's last frame again, without rendering if its buffer is retained
+    void refresh(uint8_t channel);
+
+    [[nodiscard]] bool isBusy() const;
+
+    /// Blocks until the frame in flight (if any) is out, for code that has to draw outside the scheduler
+    void waitIdle();
+
+    [[nodiscard]] Stats getStats() const;
+
+    void resetStats();
+
+    void printStats(Print &out) const;
+
+private:
+    TFTPanel *tft;
+    FaderChannel *channels;
+    FrameBufferPool *pool;
+    uint8_t refreshPending = 0; // bit per channel
+    uint8_t nextChannel = 0;
+    bool transferring = false;
+    uint32_t transferStart = 0;
+    Stats stats{};
+
+    void selectChannel(uint8_t channel) const;
+
+    void startFrame();
+
+    void finishTransfer();
+};
@@ -1,25 +1,25 @@
 #include "FaderChannel.h"
 #include <Arduino.h>
 #include "Globals.h"
+#include "IconRLE.h"
+#include "Profiler.h"
 
 
 FaderChannel::FaderChannel(const uint8_t _channelNumber, WS2812Serial *_leds, ResponsiveAnalogRead *_pot,
-                           CapacitiveSensor *_touch, ST7789_t3 *_tft,
+                           TouchScanner *_touch, TFTPanel *_tft, FaderServo *_servo, IconStore *_icons,
                            const uint8_t _forwardPin, const uint8_t _backwardPin,
                            const bool _isMaster) : appdata(_isMaster, _channelNumber) {
-    for (int i = 0; i < 3; i++) {
-        pinMode(potMuxPins[i], OUTPUT);
-        pinMode(touchMuxPins[i], OUTPUT);
-        pinMode(csMuxPins[i], OUTPUT);
-    }
     channelNumber = _channelNumber;
     leds = _leds;
     pot = _pot;
     touch = _touch;
     tft = _tft;
+    servo = _servo;
+    icons = _icons;
     isMaster = _isMaster;
     targetVolume = 50;
     motor = new FaderMotor(_forwardPin, _backwardPin);
+    servo->attach(channelNumber, motor);
 }
 
 void FaderChannel::begin() {
@@ -30,91 +30,192 @@ void FaderChannel::begin() {
 FaderChannel::~FaderChannel() = default;
 
 uint8_t FaderChannel::getFaderPosition() const {
-    setToCurrentChannel();
-    return (100 - map(analogRead(A6), positionMin + 10, positionMax - 10, 0, 100));
+    return servo->getPosition(channelNumber);
 }
 
 void FaderChannel::update() {
-    setToCurrentChannel();
     for (int i = 0; i < 4; i++) {
         leds->setPixel(i + 88 + 4 * channelNumber, encoderColor);
     }
 
+    // the motor itself is driven by the servo timer, this only feeds it the target and touch state
+    servo->setEnabled(channelNumber, !isUnUsed && !calibrating);
+    servo->setTarget(channelNumber, targetVolume);
+    touch->setEnabled(channelNumber, !isUnUsed);
     if (!isUnUsed) {
-        faderPosition = 100 - map(analogRead(A6), positionMin + 10, positionMax - 10, 0, 100);
-        if (static_cast<float>(touch->capacitiveSensor(25)) > static_cast<float>(baselineTouch) * touchSensitivity &&
-            faderPosition > TOUCH_THRESHOLD) {
-            motor->stop();
+        faderPosition = servo->getPosition(channelNumber);
+        if (touch->isTouched(channelNumber) && faderPosition > TOUCH_THRESHOLD) {
+            servo->setHold(channelNumber, true);
             setSelected(true);
             if (millis() - lastTouchChange > TOUCH_DEBOUNCE_TIME) {
                 userChanged = true;
                 lastTouchChange = millis();
             }
         } else {
+            servo->setHold(channelNumber, false);
             setSelected(false);
-            if (faderPosition > targetVolume + POSITION_DEADZONE) {
-                motor->forward(abs(faderPosition - targetVolume) < SPEED_THRESHOLD ? SLOW_SPEED : FAST_SPEED);
-            } else if (faderPosition < targetVolume - POSITION_DEADZONE) {
-                motor->backward(abs(faderPosition - targetVolume) < SPEED_THRESHOLD ? SLOW_SPEED : FAST_SPEED);
-            } else {
-                motor->stop();
-            }
         }
     }
     if (updateScreen) {
-        tft->fillScreen(0x000000);
-        tft->setTextColor(0xFFFF);
-        if (!menuOpen) {
-            if (!isUnUsed) {
-                drawIcon(SCREEN_WIDTH / 2 - iconWidth / 2, 0, iconWidth, iconHeight);
-            }
-            tft->setCursor(10, iconHeight + 10);
-            tft->println(name);
-            tft->println("PID: " + String(appdata.PID));
-        } else {
-            displayMenu();
-        }
-        tft->updateScreen();
+        screenDamage.markAll();
         updateScreen = false;
     }
+    if (menuOpen) {
+        trackMenuDamage();
+    } else if (appdata.PID != drawnPID) {
+        screenDamage.mark(REGION_PID);
+    }
+}
+
+bool FaderChannel::hasScreenChanges() const {
+    return screenDamage.any();
 }
 
-void FaderChannel::displayMenu() {
-    constexpr int ITEMS_PER_PAGE = 8;
-    const uint8_t numPages = (openProcessIDs.getSize() + ITEMS_PER_PAGE - 1) / ITEMS_PER_PAGE;
+// the display scheduler has this channel's panel selected and the frame buffer to itself while this runs
+bool FaderChannel::renderScreen() {
+    const bool full = screenDamage.isFull();
+    redrawScreen();
+    screenDamage.clear();
+    return full;
+}
+
+void FaderChannel::clampMenuSelection() {
+    const uint8_t numPages = (openProcessIDs.getSize() + MENU_ITEMS_PER_PAGE - 1) / MENU_ITEMS_PER_PAGE;
 
-    if (menuIndex >= ITEMS_PER_PAGE) {
+    if (menuIndex >= MENU_ITEMS_PER_PAGE) {
         menuPage = min(menuPage + 1, numPages - 1);
         menuIndex = 0;
     } else if (menuIndex < 0) {
         menuPage = max(menuPage - 1, 0);
         menuIndex = (menuPage < numPages - 1)
-                        ? ITEMS_PER_PAGE - 1
-                        : min(openProcessIDs.getSize() % ITEMS_PER_PAGE - 1, ITEMS_PER_PAGE - 1);
+                        ? MENU_ITEMS_PER_PAGE - 1
+                        : min(openProcessIDs.getSize() % MENU_ITEMS_PER_PAGE - 1, MENU_ITEMS_PER_PAGE - 1);
     }
 
-    menuIndex = min(menuIndex, min(ITEMS_PER_PAGE - 1, openProcessIDs.getSize() - menuPage * ITEMS_PER_PAGE - 1));
-
-    tft->setCursor(0, 0);
-    for (uint32_t i = 0; i < ITEMS_PER_PAGE; i++) {
-        if (const uint32_t processIdx = menuPage * ITEMS_PER_PAGE + i; processIdx < openProcessIDs.getSize()) {
-            if (i == menuIndex) {
-                constexpr char SELECTION_INDICATOR = 16;
-                constexpr uint16_t SELECTED_COLOR = 0x00FF;
-                tft->setTextColor(SELECTED_COLOR);
-                tft->print(SELECTION_INDICATOR);
-                tft->print(' ');
-            } else {
-                constexpr uint16_t NORMAL_COLOR = 0xFFFF;
-                tft->setTextColor(NORMAL_COLOR);
-                tft->print("  ");
-            }
+    menuIndex = min(menuIndex, min(MENU_ITEMS_PER_PAGE - 1,
+                                   openProcessIDs.getSize() - menuPage * MENU_ITEMS_PER_PAGE - 1));
+}
 
-            for (uint8_t j = 0; j < NAME_LENGTH_MAX && openProcessNames[processIdx][j] != '\0'; j++) {
-                tft->print(openProcessNames[processIdx][j]);
-            }
-            tft->println();
+// moving the selection only touches the old and the new row, a page change redraws every row
+void FaderChannel::trackMenuDamage() {
+    clampMenuSelection();
+    if (menuPage != drawnMenuPage) {
+        for (uint8_t row = 0; row < MENU_ITEMS_PER_PAGE; row++) {
+            screenDamage.mark(REGION_MENU_FIRST + row);
+        }
+    } else if (menuIndex != drawnMenuIndex) {
+        screenDamage.mark(REGION_MENU_FIRST + drawnMenuIndex);
+        screenDamage.mark(REGION_MENU_FIRST + menuIndex);
+    }
+}
+
+void FaderChannel::redrawScreen() {
+    const bool full = screenDamage.isFull();
+    // every region is exactly one line tall, so text must not wrap into the next one
+    tft->setTextWrap(false);
+    if (full) {
+        tft->fillScreen(0x000000);
+    }
+    for (uint8_t region = 0; region < REGION_COUNT; region++) {
+        if (!screenDamage.isDirty(region) || !isRegionVisible(region)) {
+            continue;
         }
+        int16_t x, y, w, h;
+        getRegionRect(region, x, y, w, h);
+        if (!full) {
+            tft->fillRect(x, y, w, h, 0x000000);
+        }
+        drawRegion(region);
+        if (!full) {
+            tft->updateRect(x, y, w, h);
+        }
+    }
+    tft->setTextWrap(true);
+    if (menuOpen) {
+        drawnMenuPage = menuPage;
+        drawnMenuIndex = menuIndex;
+    }
+}
+
+void FaderChannel::drawRegion(const uint8_t region) {
+    tft->setTextColor(0xFFFF);
+    switch (region) {
+        case REGION_ICON:
+            if (!isUnUsed) {
+                drawIcon(SCREEN_WIDTH / 2 - iconWidth / 2, 0, iconWidth, iconHeight);
+            }
+            break;
+        case REGION_NAME:
+            tft->setCursor(10, iconHeight + 10);
+            tft->print(name);
+            break;
+        case REGION_PID:
+            tft->setCursor(0, iconHeight + 10 + LINE_HEIGHT);
+            tft->print("PID: " + String(appdata.PID));
+            drawnPID = appdata.PID;
+            break;
+        default:
+            drawMenuRow(region - REGION_MENU_FIRST);
+            break;
+    }
+}
+
+void FaderChannel::drawMenuRow(const uint8_t row) const {
+    const uint32_t processIdx = menuPage * MENU_ITEMS_PER_PAGE + row;
+    if (processIdx >= openProcessIDs.getSize()) {
+        return;
+    }
+    tft->setCursor(0, row * LINE_HEIGHT);
+    if (row == menuIndex) {
+        constexpr char SELECTION_INDICATOR = 16;
+        constexpr uint16_t SELECTED_COLOR = 0x00FF;
+        tft->setTextColor(SELECTED_COLOR);
+        tft->print(SELECTION_INDICATOR);
+        tft->print(' ');
+    } else {
+        constexpr uint16_t NORMAL_COLOR = 0xFFFF;
+        tft->setTextColor(NORMAL_COLOR);
+        tft->print("  ");
+    }
+
+    for (uint8_t j = 0; j < NAME_LENGTH_MAX && openProcessNames[processIdx][j] != '\0'; j++) {
+        tft->print(openProcessNames[processIdx][j]);
+    }
+}
+
+bool FaderChannel::isRegionVisible(const uint8_t region) const {
+    if (region >= REGION_MENU_FIRST) {
+        return menuOpen;
+    }
+    return !menuOpen;
+}
+
+void FaderChannel::getRegionRect(const uint8_t region, int16_t &x, int16_t &y, int16_t &w, int16_t &h) const {
+    switch (region) {
+        case REGION_ICON:
+            x = SCREEN_WIDTH / 2 - iconWidth / 2;
+            y = 0;
+            w = iconWidth;
+            h = iconHeight;
+            break;
+        case REGION_NAME:
+            x = 0;
+            y = iconHeight + 10;
+            w = SCREEN_WIDTH;
+            h = LINE_HEIGHT;
+            break;
+        case REGION_PID:
+            x = 0;
+            y = iconHeight + 10 + LINE_HEIGHT;
+            w = SCREEN_WIDTH;
+            h = LINE_HEIGHT;
+            break;
+        default:
+            x = 0;
+            y = (region - REGION_MENU_FIRST) * LINE_HEIGHT;
+            w = SCREEN_WIDTH;
+            h = LINE_HEIGHT;
+            break;
     }
 }
 
@@ -135,9 +236,9 @@ void FaderChannel::onRotaryPress() {
             encoderColor = 0x000011;
             menuOpen = false;
             updateScreen = true;
-            if (openProcessIDs[menuPage * 8 + menuIndex] != appdata.PID) {
+            if (openProcessIDs[menuPage * MENU_ITEMS_PER_PAGE + menuIndex] != appdata.PID) {
                 requestNewProcess = true;
-                appdata.PID = openProcessIDs[menuPage * 8 + menuIndex];
+                appdata.PID = openProcessIDs[menuPage * MENU_ITEMS_PER_PAGE + menuIndex];
             }
         } else {
             encoderColor = 0x110000;
@@ -153,42 +254,53 @@ void FaderChannel::onRotaryTurn(const bool clockwise) {
         // touchSensitivity += 0.02f;
         if (menuOpen) {
             menuIndex++;
-            updateScreen = true;
         }
     } else {
         if (menuOpen) {
             menuIndex--;
-            updateScreen = true;
         }
         // touchSensitivity -= 0.02f;
     }
 }
 
+// icons are row-major RGB565, so the whole icon goes into the frame buffer as one rectangle
 void FaderChannel::drawIcon(const uint16_t x, const uint16_t y, const uint16_t width, const uint16_t height) const {
-    for (uint16_t i = 0; i < width; i++) {
-        for (uint16_t j = 0; j < height; j++) {
-            tft->drawPixel(x + i, y + j, appdata.iconBuffer[i][j]);
-        }
+    ProfileScope profile(Profiler::DRAW_ICON);
+    const uint16_t *pixels = icons->get(icon);
+    if (pixels != nullptr) {
+        tft->writeRect(x, y, width, height, pixels);
+        return;
+    }
+    // built-in icons are decoded from flash a band of rows at a time instead of into a slot
+    const BuiltinIcon *builtin = icons->getBuiltin(icon);
+    if (builtin != nullptr) {
+        struct Target {
+            TFTPanel *tft;
+            uint16_t x;
+            uint16_t y;
+        } target{tft, x, y};
+        IconRLE::draw(builtin->rle, builtin->length, [](void *context, const uint8_t firstRow,
+                                                        const uint16_t *band) {
+            const auto *target = static_cast<const Target *>(context);
+            target->tft->writeRect(target->x, target->y + firstRow, IconRLE::WIDTH, IconRLE::BAND_ROWS, band);
+        }, &target);
     }
 }
 
-void FaderChannel::setIcon(const uint16_t _icon[ICON_SIZE][ICON_SIZE], const uint16_t _iconWidth,
-                           const uint16_t _iconHeight) {
+void FaderChannel::setIcon(const IconHandle _icon, const uint16_t _iconWidth, const uint16_t _iconHeight) {
     isUnUsed = false;
-    memcpy(appdata.iconBuffer, _icon,
-           ICON_SIZE * ICON_SIZE * sizeof(uint16_t));
+    // retain first, the new icon may be the one already shown
+    icons->retain(_icon);
+    icons->release(icon);
+    icon = _icon;
+    // the text lines sit below the icon, so a different size moves everything
+    if (_iconWidth != iconWidth || _iconHeight != iconHeight) {
+        screenDamage.markAll();
+    } else {
+        screenDamage.mark(REGION_ICON);
+    }
     iconWidth = _iconWidth;
     iconHeight = _iconHeight;
-    updateScreen = true;
-}
-
-void FaderChannel::setToCurrentChannel() const {
-    for (int i = 0; i < 3; i++) {
-        digitalWrite(potMuxPins[i], bitRead(channelNumber, i));
-        digitalWrite(touchMuxPins[i], bitRead(channelNumber, i));
-        digitalWrite(csMuxPins[i], bitRead(channelNumber, i));
-    }
-    delayMicroseconds(50);
 }
 
 void FaderChannel::setMaxVolume(uint8_t volume) {
@@ -240,17 +352,14 @@ void FaderChannel::setSelected(const bool selected) const {
 }
 
 void FaderChannel::setName(const char _name[20]) {
+    const String previous = name;
     name = "";
-    bool difference = false;
     for (int i = 0; i < 20; i++) {
         strcpy(&appdata.name[i], &_name[i]);
         name += _name[i];
-        if (name[i] != _name[i]) {
-            difference = true;
-        }
     }
-    if (difference) {
-        updateScreen = true;
+    if (name != previous) {
+        screenDamage.mark(REGION_NAME);
     }
 }
 
@@ -260,6 +369,8 @@ void FaderChannel::setUnused(const bool _isUnused) {
         targetVolume = 0;
         setName("None               ");
         appdata.PID = UINT32_MAX;
+        icons->release(icon);
+        icon = NO_ICON;
         updateScreen = true;
     }
 }
@@ -268,26 +379,50 @@ void FaderChannel::setVolumeBarMode(const uint8_t mode) {
     volBarMode = mode;
 }
 
+// needs a reading taken while the fader was not touched, see waitForTouchSweep() in main.cpp
 void FaderChannel::setUnTouched() {
-    setToCurrentChannel();
-    touch->capacitiveSensor(1);
-    baselineTouch = touch->capacitiveSensor(25);
+    touch->captureBaseline(channelNumber);
 }
 
 void FaderChannel::setTouchSensitivity(const float _sensitivity) {
-    touchSensitivity = _sensitivity;
+    touch->setSensitivity(channelNumber, _sensitivity);
+}
+
+void FaderChannel::setPositionRange(const uint16_t _positionMin, const uint16_t _positionMax) {
+    positionMin = _positionMin;
+    positionMax = _positionMax;
+    servo->setRange(channelNumber, positionMin, positionMax);
+}
+
+// while calibrating the servo leaves the motor alone
+void FaderChannel::setCalibrating(const bool _calibrating) {
+    calibrating = _calibrating;
+    if (calibrating) {
+        servo->setEnabled(channelNumber, false);
+    }
 }
 
-void FaderChannel::setPositionMin() {
-    setToCurrentChannel();
-    positionMin = analogRead(A6);
+ChannelCalibration FaderChannel::getCalibration() const {
+    ChannelCalibration calibration;
+    calibration.positionMin = positionMin;
+    calibration.positionMax = positionMax;
+    calibration.touchBaseline = touch->getBaseline(channelNumber);
+    calibration.touchSensitivity = touch->getSensitivity(channelNumber);
+    return calibration;
 }
 
-void FaderChannel::setPositionMax() {
-    setToCurrentChannel();
-    positionMax = analogRead(A6);
+void FaderChannel::applyCalibration(const ChannelCalibration &calibration) {
+    positionMin = calibration.positionMin;
+    positionMax = calibration.positionMax;
+    servo->setRange(channelNumber, positionMin, positionMax);
+    touch->setBaseline(channelNumber, calibration.touchBaseline);
+    touch->setSensitivity(channelNumber, calibration.touchSensitivity);
 }
 
 bool FaderChannel::isUnused() const {
     return isUnUsed;
 }
+
+IconHandle FaderChannel::getIcon() const {
+    return icon;
+}
@@ -3,6 +3,11 @@
 #include <Arduino.h>
 #include "Globals.h"
 #include "FaderMotor.h"
+#include "FaderServo.h"
+#include "TouchScanner.h"
+#include "CalibrationStore.h"
+#include "DirtyRegions.h"
+#include "IconStore.h"
 
 class FaderChannel {
 public:
@@ -17,8 +22,8 @@ public:
     AppData appdata;
     FaderMotor *motor;
 
-    FaderChannel(uint8_t _channelNumber, WS2812Serial *_leds, ResponsiveAnalogRead *_pot, CapacitiveSensor *_touch,
-                 ST7789_t3 *_tft, uint8_t _forwardPin, uint8_t _backwardPin, bool _isMaster);
+    FaderChannel(uint8_t _channelNumber, WS2812Serial *_leds, ResponsiveAnalogRead *_pot, TouchScanner *_touch,
+                 TFTPanel *_tft, FaderServo *_servo, IconStore *_icons, uint8_t _forwardPin, uint8_t _backwardPin, bool _isMaster);
 
     ~FaderChannel();
 
@@ -26,13 +31,15 @@ public:
 
     void begin();
 
-    void displayMenu();
-
     [[nodiscard]] uint8_t getFaderPosition() const;
 
-    void setIcon(const uint16_t _icon[ICON_SIZE][ICON_SIZE], uint16_t _iconWidth, uint16_t _iconHeight);
+    /// Takes its own reference to the icon and drops the one to the icon it showed before
+    void setIcon(IconHandle _icon, uint16_t _iconWidth, uint16_t _iconHeight);
+
+    [[nodiscard]] bool hasScreenChanges() const;
 
-    void setToCurrentChannel() const;
+    /// Draws the changed parts of the screen, returns true if the caller has to send the whole frame
+    bool renderScreen();
 
     void setMaxVolume(uint8_t volume);
 
@@ -56,13 +63,30 @@ public:
 
     void setTouchSensitivity(float _sensitivity);
 
-    void setPositionMin();
+    void setPositionRange(uint16_t _positionMin, uint16_t _positionMax);
+
+    void setCalibrating(bool _calibrating);
+
+    [[nodiscard]] ChannelCalibration getCalibration() const;
 
-    void setPositionMax();
+    void applyCalibration(const ChannelCalibration &calibration);
 
     [[nodiscard]] bool isUnused() const;
 
+    [[nodiscard]] IconHandle getIcon() const;
+
 private:
+    /// Parts of the screen that can be redrawn and sent on their own
+    enum ScreenRegion : uint8_t {
+        REGION_ICON,
+        REGION_NAME,
+        REGION_PID,
+        REGION_MENU_FIRST, // one region per menu row
+    };
+
+    static constexpr uint8_t MENU_ITEMS_PER_PAGE = 8;
+    static constexpr uint8_t REGION_COUNT = REGION_MENU_FIRST + MENU_ITEMS_PER_PAGE;
+    static constexpr int16_t LINE_HEIGHT = 16; // text size 2
     static constexpr uint32_t ledStates[2][4] = {
         {ZERO, ONE, TWO, THREE}, // volBarMode 0
         {ZERO, ONE, JUSTTWO, JUSTTHREE} // volBarMode 1
@@ -78,24 +102,40 @@ private:
     String name;
     WS2812Serial *leds;
     ResponsiveAnalogRead *pot; //TODO: see if this is necessary
-    CapacitiveSensor *touch;
-    ST7789_t3 *tft;
+    TouchScanner *touch;
+    TFTPanel *tft;
+    FaderServo *servo;
+    IconStore *icons;
+    IconHandle icon = NO_ICON;
     uint32_t encoderColor = 0x000011;
-    uint32_t baselineTouch = 0;
     uint32_t lastTouchChange = 0;
-    float touchSensitivity = 1.5f; //TODO: allow this to be changed in the menu
     bool userTouching = false;
     bool isMaster = false;
     bool isUnUsed = false;
+    bool calibrating = false;
+    DirtyRegions screenDamage;
+    uint32_t drawnPID = UINT32_MAX;
+    uint8_t drawnMenuPage = 0;
+    uint8_t drawnMenuIndex = 0;
 
     const uint8_t TOUCH_THRESHOLD = 5;
-    const uint8_t POSITION_DEADZONE = 3;
-    const uint8_t SPEED_THRESHOLD = 20;
-    const uint8_t SLOW_SPEED = 40;
-    const uint8_t FAST_SPEED = 60;
     const uint32_t TOUCH_DEBOUNCE_TIME = 100;
 
     void drawIcon(uint16_t x, uint16_t y, uint16_t width, uint16_t height) const;
 
+    void clampMenuSelection();
+
+    void trackMenuDamage();
+
+    void redrawScreen();
+
+    void drawRegion(uint8_t region);
+
+    void drawMenuRow(uint8_t row) const;
+
+    [[nodiscard]] bool isRegionVisible(uint8_t region) const;
+
+    void getRegionRect(uint8_t region, int16_t &x, int16_t &y, int16_t &w, int16_t &h) const;
+
     void setSelected(bool selected) const;
 };
@@ -0,0 +1,96 @@
+#include "FaderController.h"
+#include <Arduino.h>
+#include <cmath>
+
+
+void FaderController::setGains(const Gains &_gains) {
+    gains = _gains;
+    integral = 0;
+}
+
+const FaderController::Gains &FaderController::getGains() const {
+    return gains;
+}
+
+// start a fresh move from wherever the fader is, used after a touch or while the channel is disabled
+void FaderController::reset(const float position) {
+    setpoint = position;
+    velocity = 0;
+    integral = 0;
+    lastPosition = position;
+    derivative = 0;
+    settled = true;
+}
+
+int8_t FaderController::update(const float target, const float position, const float dt) {
+    const float distance = fabsf(target - position);
+    // hysteresis so a fader resting at the edge of the tolerance does not hunt
+    if (settled && distance > 2.0f * gains.tolerance) {
+        settled = false;
+        setpoint = position;
+        velocity = 0;
+    }
+    derivative += DERIVATIVE_FILTER * ((lastPosition - position) / dt - derivative);
+    lastPosition = position;
+    if (settled) {
+        return 0;
+    }
+
+    stepProfile(target, dt);
+
+    // stop inside the tolerance, a single noisy reading at its edge would leave the fader just outside
+    if (setpoint == target && distance <= gains.tolerance * SETTLE_BAND) {
+        settled = true;
+        integral = 0;
+        return 0;
+    }
+
+    const float error = setpoint - position;
+    const float limit = gains.maxOutput;
+    // the profile's own lag is no steady-state error, integrating it only winds up into overshoot
+    if (setpoint == target) {
+        const float candidate = constrain(integral + gains.ki * error * dt, -limit, limit);
+        const float unsaturated = gains.kp * error + candidate + gains.kd * derivative;
+        if (fabsf(unsaturated) <= limit || (unsaturated > 0) != (error > 0)) {
+            integral = candidate;
+        }
+    } else {
+        integral = 0;
+    }
+
+    float output = constrain(gains.kp * error + integral + gains.kd * derivative, -limit, limit);
+    if (fabsf(output) < gains.minOutput) {
+        output = error > 0 ? gains.minOutput : -static_cast<float>(gains.minOutput);
+    }
+    return static_cast<int8_t>(lroundf(output));
+}
+
+bool FaderController::isSettled() const {
+    return settled;
+}
+
+// trapezoidal profile: accelerate toward the target, cruise, and brake so the setpoint stops on the target
+void FaderController::stepProfile(const float target, const float dt) {
+    const float remaining = target - setpoint;
+    if (remaining == 0 && velocity == 0) {
+        return;
+    }
+    const float direction = remaining > 0 ? 1.0f : -1.0f;
+    const float brakingDistance = velocity * velocity / (2.0f * gains.maxAcceleration);
+    if (velocity * direction > 0 && fabsf(remaining) <= brakingDistance) {
+        velocity -= direction * gains.maxAcceleration * dt;
+        if (velocity * direction < 0) {
+            velocity = 0;
+        }
+    } else {
+        velocity = constrain(velocity + direction * gains.maxAcceleration * dt, -gains.maxVelocity,
+                             gains.maxVelocity);
+    }
+    setpoint += velocity * dt;
+
+    const float after = target - setpoint;
+    if ((after > 0) != (remaining > 0) || fabsf(after) < 0.5f) {
+        setpoint = target;
+        velocity = 0;
+    }
+}
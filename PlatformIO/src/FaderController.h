@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Closed-loop position controller for one motorized fader
+ *
+ * A trapezoidal velocity profile moves an internal setpoint toward the target at a bounded speed and
+ * acceleration, and a PID loop makes the fader follow that setpoint. Positions are raw ADC counts, the output
+ * is a signed motor drive percentage (positive is FaderMotor::forward, i.e. increasing ADC counts).
+ *
+ * Anti-windup: the integral is held at zero while the profile is still moving, is clamped to the output range and
+ * only accumulates while the output is not saturated in the direction of the error. The derivative acts on the
+ * measurement so target steps do not kick. A move ends inside SETTLE_BAND of the tolerance, leaving room for ADC
+ * noise before the fader counts as off target again.
+ */
+class FaderController {
+public:
+    struct Gains {
+        /// Proportional gain (drive % per count)
+        float kp = 0.6f;
+        /// Integral gain (drive % per count-second)
+        float ki = 6.0f;
+        /// Derivative gain (drive % per count/second)
+        float kd = 0.004f;
+        /// Profile cruise speed (counts per second)
+        float maxVelocity = 4000.0f;
+        /// Profile acceleration (counts per second squared)
+        float maxAcceleration = 40000.0f;
+        /// Smallest drive that still moves the fader against static friction
+        uint8_t minOutput = 18;
+        /// Drive limit
+        uint8_t maxOutput = 100;
+        /// Distance from the target that counts as settled (counts)
+        uint16_t tolerance = 6;
+    };
+
+    FaderController() = default;
+
+    ~FaderController() = default;
+
+    void setGains(const Gains &_gains);
+
+    [[nodiscard]] const Gains &getGains() const;
+
+    void reset(float position);
+
+    [[nodiscard]] int8_t update(float target, float position, float dt);
+
+    [[nodiscard]] bool isSettled() const;
+
+private:
+    static constexpr float DERIVATIVE_FILTER = 0.2f;
+    /// Fraction of the tolerance a move has to get within before it stops
+    static constexpr float SETTLE_BAND = 0.6f;
+
+    Gains gains;
+    float setpoint = 0;
+    float velocity = 0;
+    float integral = 0;
+    float lastPosition = 0;
+    float derivative = 0;
+    bool settled = true;
+
+    void stepProfile(float target, float dt);
+};
@@ -42,3 +42,22 @@ void FaderMotor::stop() const {
     analogWrite(forwardPin, 0);
     analogWrite(backwardPin, 0);
 }
+
+// signed speed, positive runs forward and negative runs backward
+void FaderMotor::drive(const int8_t speedPercentage) const {
+    if (speedPercentage > 0) {
+        forward(speedPercentage);
+    } else if (speedPercentage < 0) {
+        backward(-speedPercentage);
+    } else {
+        stop();
+    }
+}
+
+uint8_t FaderMotor::getForwardPin() const {
+    return forwardPin;
+}
+
+uint8_t FaderMotor::getBackwardPin() const {
+    return backwardPin;
+}
@@ -9,6 +9,9 @@ public:
     void forward(uint8_t speedPercentage) const;
     void backward(uint8_t speedPercentage) const;
     void stop() const;
+    void drive(int8_t speedPercentage) const;
+    [[nodiscard]] uint8_t getForwardPin() const;
+    [[nodiscard]] uint8_t getBackwardPin() const;
 
 private:
     uint8_t forwardPin;
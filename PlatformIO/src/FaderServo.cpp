@@ -0,0 +1,143 @@
+#include "FaderServo.h"
+#include <Arduino.h>
+
+
+FaderServo::FaderServo(const ReadPositionFunction _readPosition) {
+    readPosition = _readPosition;
+}
+
+void FaderServo::attach(const uint8_t channel, FaderMotor *motor) {
+    channels[channel].motor = motor;
+}
+
+// called from the servo timer
+void FaderServo::tick(const uint32_t nowMicros) {
+    for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+        service(channels[channel], channel, nowMicros);
+    }
+}
+
+void FaderServo::setTarget(const uint8_t channel, uint8_t volume) {
+    if (volume > 100) {
+        volume = 100;
+    }
+    channels[channel].target = volume;
+}
+
+void FaderServo::setHold(const uint8_t channel, const bool hold) {
+    channels[channel].hold = hold;
+}
+
+void FaderServo::setEnabled(const uint8_t channel, const bool enabled) {
+    channels[channel].enabled = enabled;
+}
+
+void FaderServo::setRange(const uint8_t channel, const uint16_t positionMin, const uint16_t positionMax) {
+    noInterrupts();
+    channels[channel].positionMin = positionMin;
+    channels[channel].positionMax = positionMax;
+    interrupts();
+}
+
+void FaderServo::setGains(const uint8_t channel, const FaderController::Gains &gains) {
+    noInterrupts();
+    channels[channel].controller.setGains(gains);
+    interrupts();
+}
+
+FaderController::Gains FaderServo::getGains(const uint8_t channel) const {
+    noInterrupts();
+    const FaderController::Gains gains = channels[channel].controller.getGains();
+    interrupts();
+    return gains;
+}
+
+bool FaderServo::isSettled(const uint8_t channel) const {
+    return channels[channel].controller.isSettled();
+}
+
+uint16_t FaderServo::getRawPosition(const uint8_t channel) const {
+    return channels[channel].rawPosition;
+}
+
+uint8_t FaderServo::getPosition(const uint8_t channel) const {
+    return channels[channel].position;
+}
+
+FaderServo::ChannelStats FaderServo::getStats(const uint8_t channel) const {
+    noInterrupts();
+    const ChannelStats stats = channels[channel].stats;
+    interrupts();
+    return stats;
+}
+
+void FaderServo::resetStats() {
+    noInterrupts();
+    for (auto &state: channels) {
+        state.stats = {};
+    }
+    interrupts();
+}
+
+uint8_t FaderServo::mapPosition(const ChannelState &state, const uint16_t raw) const {
+    const long mapped = map(raw, state.positionMin + 10, state.positionMax - 10, 0, 100);
+    return 100 - constrain(mapped, 0L, 100L);
+}
+
+void FaderServo::service(ChannelState &state, const uint8_t channel, const uint32_t nowMicros) {
+    recordTiming(state, nowMicros);
+    state.rawPosition = readPosition(channel);
+    state.position = mapPosition(state, state.rawPosition);
+
+    if (state.motor != nullptr) {
+        if (state.enabled && !state.hold) {
+            drive(state);
+        } else {
+            state.controller.reset(state.rawPosition);
+            stopMotor(state);
+        }
+    }
+}
+
+// inverse of mapPosition, the controller works in raw counts for the extra resolution
+float FaderServo::targetToRaw(const ChannelState &state) const {
+    const float low = state.positionMin + 10;
+    const float high = state.positionMax - 10;
+    return low + (100 - state.target) * (high - low) / 100.0f;
+}
+
+void FaderServo::drive(ChannelState &state) {
+    const int8_t output = state.controller.update(targetToRaw(state), state.rawPosition, CHANNEL_PERIOD_SECONDS);
+    if (output == 0) {
+        stopMotor(state);
+    } else {
+        state.motor->drive(output);
+        state.motorRunning = true;
+    }
+}
+
+void FaderServo::stopMotor(ChannelState &state) {
+    // only touch the PWM pins when something changes, calibration drives the motors directly while disabled
+    if (state.motorRunning) {
+        state.motor->stop();
+        state.motorRunning = false;
+    }
+}
+
+void FaderServo::recordTiming(ChannelState &state, const uint32_t nowMicros) {
+    if (state.stats.ticks > 0) {
+        const uint32_t interval = nowMicros - state.lastServiceMicros;
+        const uint32_t jitter = interval > CHANNEL_PERIOD_MICROS
+                                    ? interval - CHANNEL_PERIOD_MICROS
+                                    : CHANNEL_PERIOD_MICROS - interval;
+        state.stats.lastJitterMicros = jitter;
+        if (jitter > state.stats.maxJitterMicros) {
+            state.stats.maxJitterMicros = jitter;
+        }
+        if (interval >= CHANNEL_PERIOD_MICROS + TICK_PERIOD_MICROS) {
+            state.stats.overruns++;
+        }
+    }
+    state.lastServiceMicros = nowMicros;
+    state.stats.ticks++;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Globals.h"
+#include "FaderMotor.h"
+#include "FaderController.h"
+
+/**
+ * @brief Fixed-rate position servo for all fader motors
+ *
+ * tick() is driven from a 1 kHz IntervalTimer so motor response does not depend on how long loop() spends
+ * drawing or talking to the computer. Every tick services all eight channels from the latest samples the
+ * PotScanner took in the background, so the servo never touches the pot mux or waits for a conversion.
+ *
+ * The position source is passed in as a plain function and the clock is passed to tick(), so the servo can run
+ * against a fake clock, ADC and motor in a host build.
+ */
+class FaderServo {
+public:
+    /// 1 kHz tick, every channel is serviced on every tick
+    static constexpr uint32_t TICK_PERIOD_MICROS = 1000;
+    static constexpr uint32_t CHANNEL_PERIOD_MICROS = TICK_PERIOD_MICROS;
+
+    using ReadPositionFunction = uint16_t (*)(uint8_t channel);
+
+    struct ChannelStats {
+        /// Number of times the channel has been serviced
+        uint32_t ticks;
+        /// Services that came at least one tick late, i.e. a timer tick was missed or delayed by a whole period
+        uint32_t overruns;
+        /// Deviation of the last service interval from CHANNEL_PERIOD_MICROS
+        uint32_t lastJitterMicros;
+        /// Largest deviation seen since the last resetStats()
+        uint32_t maxJitterMicros;
+    };
+
+    explicit FaderServo(ReadPositionFunction _readPosition);
+
+    void attach(uint8_t channel, FaderMotor *motor);
+
+    void tick(uint32_t nowMicros);
+
+    void setTarget(uint8_t channel, uint8_t volume);
+
+    void setHold(uint8_t channel, bool hold);
+
+    void setEnabled(uint8_t channel, bool enabled);
+
+    void setRange(uint8_t channel, uint16_t positionMin, uint16_t positionMax);
+
+    void setGains(uint8_t channel, const FaderController::Gains &gains);
+
+    [[nodiscard]] FaderController::Gains getGains(uint8_t channel) const;
+
+    [[nodiscard]] bool isSettled(uint8_t channel) const;
+
+    [[nodiscard]] uint16_t getRawPosition(uint8_t channel) const;
+
+    [[nodiscard]] uint8_t getPosition(uint8_t channel) const;
+
+    [[nodiscard]] ChannelStats getStats(uint8_t channel) const;
+
+    void resetStats();
+
+private:
+    struct ChannelState {
+        FaderMotor *motor = nullptr;
+        volatile uint16_t rawPosition = 0;
+        volatile uint8_t position = 0;
+        volatile uint8_t target = 50;
+        volatile bool enabled = false;
+        volatile bool hold = false;
+        bool motorRunning = false;
+        uint16_t positionMin = 100;
+        uint16_t positionMax = 950;
+        uint32_t lastServiceMicros = 0;
+        FaderController controller;
+        ChannelStats stats{};
+    };
+
+    static constexpr float CHANNEL_PERIOD_SECONDS = CHANNEL_PERIOD_MICROS / 1000000.0f;
+
+    ReadPositionFunction readPosition;
+    ChannelState channels[CHANNELS];
+
+    [[nodiscard]] uint8_t mapPosition(const ChannelState &state, uint16_t raw) const;
+
+    [[nodiscard]] float targetToRaw(const ChannelState &state) const;
+
+    void service(ChannelState &state, uint8_t channel, uint32_t nowMicros);
+
+    void drive(ChannelState &state);
+
+    void stopMotor(ChannelState &state);
+
+    static void recordTiming(ChannelState &state, uint32_t nowMicros);
+};
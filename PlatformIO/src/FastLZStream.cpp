@@ -0,0 +1,222 @@
+#include "FastLZStream.h"
+#include <Arduino.h>
+
+
+void FastLZStream::begin(uint8_t *_output, const uint32_t _outputSize, const uint32_t inputSize) {
+    output = _output;
+    outputSize = _outputSize;
+    produced = 0;
+    inputLeft = inputSize;
+    count = 0;
+    offset = 0;
+    state = State::FIRST;
+    level2 = false;
+    status = output != nullptr && inputSize > 0 ? Status::RUNNING : Status::ERROR;
+}
+
+// same instruction decoding as fastlz1_decompress() and fastlz2_decompress(), one byte of state at a time.
+// FASTRUN keeps the decoder in ITCM even if the default placement of code changes.
+FASTRUN FastLZStream::Status FastLZStream::feed(const uint8_t *input, uint32_t length) {
+    if (status != Status::RUNNING) {
+        return status;
+    }
+    length = min(length, inputLeft);
+    inputLeft -= length;
+    const uint8_t *ip = input;
+    const uint8_t *end = input + length;
+    while (ip < end) {
+        if (state == State::CONTROL) {
+            if (!decodeFast(ip, end)) {
+                return status;
+            }
+            if (ip == end) {
+                break;
+            }
+        }
+        switch (state) {
+            case State::FIRST: {
+                const uint8_t level = (*ip >> 5) + 1;
+                if (level > 2) {
+                    fail();
+                    return status;
+                }
+                level2 = level == 2;
+                count = (*ip++ & 31) + 1;
+                state = State::LITERAL;
+                break;
+            }
+            case State::CONTROL: {
+                const uint8_t ctrl = *ip++;
+                if (ctrl < 32) {
+                    count = ctrl + 1;
+                    state = State::LITERAL;
+                } else {
+                    count = (ctrl >> 5) - 1;
+                    offset = (ctrl & 31) << 8;
+                    state = count == 7 - 1 ? State::LENGTH : State::DISTANCE;
+                }
+                break;
+            }
+            case State::LITERAL: {
+                const uint32_t run = min(count, static_cast<uint32_t>(end - ip));
+                if (produced + run > outputSize) {
+                    fail();
+                    return status;
+                }
+                memcpy(output + produced, ip, run);
+                produced += run;
+                ip += run;
+                count -= run;
+                if (count == 0) {
+                    state = State::CONTROL;
+                }
+                break;
+            }
+            case State::LENGTH: {
+                // level 1 has a single length byte, level 2 continues while the bytes are 255
+                const uint8_t code = *ip++;
+                count += code;
+                if (!level2 || code != 255) {
+                    state = State::DISTANCE;
+                }
+                break;
+            }
+            case State::DISTANCE: {
+                const uint8_t code = *ip++;
+                if (level2 && code == 255 && offset == 31 << 8) {
+                    state = State::FAR_HIGH;
+                    break;
+                }
+                if (!copyMatch(offset + code + 1)) {
+                    return status;
+                }
+                break;
+            }
+            case State::FAR_HIGH:
+                offset = *ip++ << 8;
+                state = State::FAR_LOW;
+                break;
+            case State::FAR_LOW:
+                offset += *ip++;
+                if (!copyMatch(offset + MAX_L2_DISTANCE + 1)) {
+                    return status;
+                }
+                break;
+        }
+    }
+    if (inputLeft == 0) {
+        status = state == State::CONTROL && produced == outputSize ? Status::DONE : Status::ERROR;
+    }
+    return status;
+}
+
+// Whole instructions while they are complete in this piece, which saves the state changes. Literals with 32
+// bytes of input left and short matches are copied as a fixed 32 or 16 bytes (a few word moves, not a memcpy
+// call); the bytes past the end of such a copy are overwritten by the next instructions. Level 2 length chains
+// and far distances, and instructions split between pieces, go back to the state machine.
+FASTRUN bool FastLZStream::decodeFast(const uint8_t *&ip, const uint8_t *end) {
+    while (ip < end) {
+        const uint8_t ctrl = *ip;
+        if (ctrl < 32) {
+            const uint32_t run = ctrl + 1;
+            const uint32_t available = end - ip - 1;
+            if (available < run) {
+                return true;
+            }
+            if (produced + run > outputSize) {
+                fail();
+                return false;
+            }
+            if (available >= MAX_LITERAL && produced + MAX_LITERAL <= outputSize) {
+                memcpy(output + produced, ip + 1, MAX_LITERAL);
+            } else {
+                memcpy(output + produced, ip + 1, run);
+            }
+            produced += run;
+            ip += 1 + run;
+            continue;
+        }
+        const bool longMatch = ctrl >> 5 == 7;
+        if ((longMatch && level2) || end - ip < (longMatch ? 3 : 2)) {
+            return true;
+        }
+        ip++;
+        count = (ctrl >> 5) - 1;
+        offset = (ctrl & 31) << 8;
+        if (longMatch) {
+            count += *ip++;
+        }
+        const uint8_t code = *ip++;
+        if (level2 && code == 255 && offset == 31 << 8) {
+            state = State::FAR_HIGH;
+            return true;
+        }
+        const uint32_t distance = offset + code + 1;
+        const uint32_t matchLength = count + 3;
+        const bool shortCopy = matchLength <= SHORT_MATCH && distance <= produced &&
+                               produced + SHORT_MATCH <= outputSize;
+        if (shortCopy && distance >= SHORT_MATCH) {
+            memcpy(output + produced, output + produced - distance, SHORT_MATCH);
+            produced += matchLength;
+        } else if (shortCopy && distance == 2) {
+            // one repeated RGB565 pixel, the most common match in icons with gradients
+            uint16_t pixel;
+            memcpy(&pixel, output + produced - 2, sizeof(pixel));
+            const uint32_t pattern = pixel | static_cast<uint32_t>(pixel) << 16;
+            const uint32_t words[SHORT_MATCH / 4] = {pattern, pattern, pattern, pattern};
+            memcpy(output + produced, words, SHORT_MATCH);
+            produced += matchLength;
+        } else if (!copyMatch(distance)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+FastLZStream::Status FastLZStream::getStatus() const {
+    return status;
+}
+
+uint32_t FastLZStream::getOutputLength() const {
+    return produced;
+}
+
+// A match shorter than its distance is a plain copy. An overlapping one repeats the last distance bytes, which
+// is what fastlz_memmove() produces copying forward byte by byte; flat colours are distance 2 (one RGB565
+// pixel) or a multiple of it. Instead of byte copies the pattern is written once and then doubled with memcpy,
+// which moves words, so a 264 byte run of one colour takes 8 copies instead of 264 byte loads and stores.
+FASTRUN bool FastLZStream::copyMatch(const uint32_t distance) {
+    const uint32_t length = count + 3;
+    if (distance > produced || produced + length > outputSize) {
+        fail();
+        return false;
+    }
+    uint8_t *op = output + produced;
+    const uint8_t *ref = op - distance;
+    if (distance >= length) {
+        memcpy(op, ref, length);
+    } else if (length <= SHORT_MATCH) {
+        // too short for the doubling to beat a byte loop
+        for (uint32_t i = 0; i < length; i++) {
+            op[i] = ref[i];
+        }
+    } else if (distance == 1) {
+        memset(op, *ref, length);
+    } else {
+        memcpy(op, ref, distance);
+        uint32_t done = distance;
+        while (done < length) {
+            // the output repeats every distance bytes and done is a multiple of it
+            const uint32_t chunk = min(done, length - done);
+            memcpy(op + done, op, chunk);
+            done += chunk;
+        }
+    }
+    produced += length;
+    state = State::CONTROL;
+    return true;
+}
+
+void FastLZStream::fail() {
+    status = Status::ERROR;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Incremental FastLZ (level 1 and 2) decoder
+ *
+ * Takes the compressed stream in pieces of any size, e.g. one ICON_PACKET payload at a time, and writes the
+ * output straight into its final buffer. Only a handful of bytes of state survive between pieces (the half read
+ * instruction and how much of a literal run is left), matches refer back into the output itself.
+ *
+ * Produces the same output as fastlz_decompress() for any stream that decompresses there, and like it never
+ * writes outside the output buffer or reads before its start on corrupt input.
+ */
+class FastLZStream {
+public:
+    enum class Status : uint8_t {
+        RUNNING,
+        DONE,
+        ERROR,
+    };
+
+    FastLZStream() = default;
+
+    ~FastLZStream() = default;
+
+    /// inputSize is the whole compressed length, the stream is only DONE once exactly outputSize bytes came out
+    void begin(uint8_t *output, uint32_t outputSize, uint32_t inputSize);
+
+    /// Bytes past the announced input size (packet padding) are ignored
+    Status feed(const uint8_t *input, uint32_t length);
+
+    [[nodiscard]] Status getStatus() const;
+
+    [[nodiscard]] uint32_t getOutputLength() const;
+
+private:
+    enum class State : uint8_t {
+        FIRST, // level marker and first literal run
+        CONTROL,
+        LITERAL,
+        LENGTH,
+        DISTANCE,
+        FAR_HIGH, // level 2 16 bit distance
+        FAR_LOW,
+    };
+
+    // level 2 distances past this are coded in two extra bytes
+    static constexpr uint32_t MAX_L2_DISTANCE = 8191;
+    static constexpr uint8_t MAX_LITERAL = 32;
+    static constexpr uint8_t SHORT_MATCH = 16;
+
+    uint8_t *output = nullptr;
+    uint32_t outputSize = 0;
+    uint32_t produced = 0;
+    uint32_t inputLeft = 0;
+    uint32_t count = 0; // literal bytes left, or match length so far
+    uint32_t offset = 0; // high bits of the match distance
+    State state = State::FIRST;
+    Status status = Status::ERROR;
+    bool level2 = false;
+
+    bool decodeFast(const uint8_t *&ip, const uint8_t *end);
+
+    bool copyMatch(uint32_t distance);
+
+    void fail();
+};
@@ -0,0 +1,64 @@
+#include "FrameBufferPool.h"
+#include <Arduino.h>
+
+
+FrameBufferPool::FrameBufferPool(MemoryArena *_psram, MemoryArena *_ram2) {
+    psram = _psram;
+    ram2 = _ram2;
+}
+
+bool FrameBufferPool::begin() {
+    retained = psram->isReady() && frames.begin(psram, CHANNELS, CHANNELS, "frame buffers") == CHANNELS;
+    if (!retained && frames.begin(ram2, 1, 1, "frame buffer") == 0) {
+        return false;
+    }
+    for (uint8_t frame = 0; frame < frames.getCount(); frame++) {
+        memset(frames.get(frame), 0, FRAME_BYTES);
+    }
+    return true;
+}
+
+uint16_t *FrameBufferPool::get(const uint8_t channel) const {
+    return frames.get(retained ? channel : 0);
+}
+
+bool FrameBufferPool::isRetained() const {
+    return retained;
+}
+
+size_t FrameBufferPool::getBytesAllocated() const {
+    return frames.getCount() * FRAME_BYTES;
+}
+
+// address ranges from the IMXRT1062 memory map as used by the Teensy 4.1 linker script
+FrameBufferPool::MemoryRegion FrameBufferPool::regionOf(const void *address) {
+    const auto value = reinterpret_cast<uintptr_t>(address);
+    if (value < 0x00080000 || (value >= 0x20000000 && value < 0x20080000)) {
+        return MemoryRegion::RAM1;
+    }
+    if (value >= 0x20200000 && value < 0x20280000) {
+        return MemoryRegion::RAM2;
+    }
+    if (value >= 0x60000000 && value < 0x70000000) {
+        return MemoryRegion::FLASH;
+    }
+    if (value >= 0x70000000 && value < 0x80000000) {
+        return MemoryRegion::PSRAM;
+    }
+    return MemoryRegion::UNKNOWN;
+}
+
+const char *FrameBufferPool::regionName(const MemoryRegion region) {
+    switch (region) {
+        case MemoryRegion::RAM1:
+            return "RAM1";
+        case MemoryRegion::RAM2:
+            return "RAM2";
+        case MemoryRegion::PSRAM:
+            return "PSRAM";
+        case MemoryRegion::FLASH:
+            return "FLASH";
+        default:
+            return "?";
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Globals.h"
+#include "BlockPool.h"
+#include "MemoryArena.h"
+
+/**
+ * @brief One retained frame buffer per channel screen
+ *
+ * Each panel keeps its last frame in its own buffer, so switching the tft between channels needs no re-render
+ * and a channel can be sent again as is. At 115 KB per frame the eight buffers only fit in the PSRAM arena;
+ * without PSRAM the pool falls back to a single buffer from the RAM2 arena shared by all channels (isRetained()
+ * is false then and switching channels means drawing the full screen again).
+ */
+class FrameBufferPool {
+public:
+    static constexpr size_t FRAME_BYTES = SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t);
+
+    enum class MemoryRegion : uint8_t {
+        RAM1, // ITCM/DTCM
+        RAM2, // OCRAM, DMAMEM and the malloc heap
+        PSRAM, // EXTMEM
+        FLASH,
+        UNKNOWN,
+    };
+
+    FrameBufferPool(MemoryArena *_psram, MemoryArena *_ram2);
+
+    ~FrameBufferPool() = default;
+
+    bool begin();
+
+    [[nodiscard]] uint16_t *get(uint8_t channel) const;
+
+    [[nodiscard]] bool isRetained() const;
+
+    [[nodiscard]] size_t getBytesAllocated() const;
+
+    [[nodiscard]] static MemoryRegion regionOf(const void *address);
+
+    [[nodiscard]] static const char *regionName(MemoryRegion region);
+
+private:
+    MemoryArena *psram;
+    MemoryArena *ram2;
+    BlockPool<uint16_t, SCREEN_WIDTH * SCREEN_HEIGHT> frames;
+    bool retained = false;
+};
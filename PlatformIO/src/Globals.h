@@ -3,17 +3,16 @@
 #include <Arduino.h>
 #include <ByteArrayQueue.h>
 #include <ST7789_t3.h>
-#include <CapacitiveSensor.h>
 #include <ResponsiveAnalogRead.h>
 #include <WS2812Serial.h>
 #include <RoxMux.h>
 #include "StaticVector.h"
-#include "smalloc.h"
+#include "TFTPanel.h"
 
 
 // Constants
 /***************************************************/
-static constexpr uint8_t API_VERSION = 1;
+static constexpr uint8_t API_VERSION = 4;
 static constexpr uint8_t NAME_LENGTH_MAX = 20;
 static constexpr uint8_t MAX_PROCESSES = 50;
 static constexpr uint8_t ICON_SIZE = 128;
@@ -37,8 +36,6 @@ static constexpr size_t SCREEN_HEIGHT = 240;
 #define SELECTED 0x000055
 
 
- //inline uint16_t globalIconBuffer[CHANNELS][ICON_SIZE][ICON_SIZE];
-
 // Data Structures
 /***************************************************/
 struct AppData {
@@ -50,45 +47,8 @@ struct AppData {
     bool isDefaultIcon = false;
     uint32_t PID = 0;
     char name[NAME_LENGTH_MAX]{};
-    uint16_t iconBuffer[ICON_SIZE][ICON_SIZE]{};
-};
-
-struct StoredData {
-    StoredData() : iconInUse(nullptr) {
-        iconInUse = static_cast<uint16_t *>(extmem_malloc(ICON_SIZE * ICON_SIZE * sizeof(uint16_t)));
-        memset(name, 0, sizeof(name));
-    }
-
-    ~StoredData() {
-        if (iconInUse != nullptr) {
-            extmem_free(iconInUse);
-            iconInUse = nullptr;
-        }
-    }
-
-    uint16_t *iconInUse;
-    uint32_t iconPID = 0;
-    char name[NAME_LENGTH_MAX]{};
-
-    void storeIcon(uint16_t iconData[ICON_SIZE][ICON_SIZE]) const {
-        if (iconInUse != nullptr) {
-            memcpy(iconInUse, iconData, ICON_SIZE * ICON_SIZE * sizeof(uint16_t));
-        }
-    }
-
-    void retrieveIcon(uint16_t iconData[ICON_SIZE][ICON_SIZE]) const {
-        if (iconInUse != nullptr) {
-            memcpy(iconData, iconInUse, ICON_SIZE * ICON_SIZE * sizeof(uint16_t));
-        }
-    }
 };
 
-inline smalloc_pool EXTM_Pool;
-DMAMEM inline uint8_t compressionBuffer[ICON_SIZE * ICON_SIZE * 2 * 21 / 20 + 66]; // 5% larger than input + 66 bytes
-inline uint32_t compressionIndex = 0;
-inline uint32_t compressionSize = 0;
-inline StoredData storedData[25]; //TODO: used for storing data in PSRAM (not implemented yet)
-
 // LED Strip
 /***************************************************/
 static constexpr uint8_t LED_PIN = 35;
@@ -106,14 +66,12 @@ static constexpr uint8_t TFT_RST = 10;
 static constexpr uint8_t TFT_MOSI = 11;
 static constexpr uint8_t TFT_SCLK = 13;
 static constexpr uint8_t CS_LOCK = 27; // Allows for all screens to be updated at once
-inline auto tft = ST7789_t3(TFT_CS, TFT_DC, TFT_RST);
-inline uint16_t frameBuffer[16000]; // 32000 bytes of memory allocated for the frame buffer
+inline auto tft = TFTPanel(TFT_CS, TFT_DC, TFT_RST);
 
 // Capacitive Touch
 /***************************************************/
 static constexpr uint8_t TOUCH_SEND = A2;
 static constexpr uint8_t TOUCH_RECEIVE = A3;
-inline auto capSensor = CapacitiveSensor(TOUCH_SEND, TOUCH_RECEIVE);
 
 // Rotary Encoders
 /***************************************************/
@@ -128,6 +86,7 @@ inline RoxButton leButton[16]; // 16 RGB LED buttons
 // Faders
 /***************************************************/
 static constexpr uint8_t POT_INPUT = A6;
+static constexpr uint8_t POT_ADC_CHANNEL = 15; // A6 (pin 20) is ADC1 input 15
 inline ResponsiveAnalogRead analog(33, true); // not currently used / needed
 
 // Mux Pins
@@ -140,13 +99,9 @@ static constexpr uint8_t csMuxPins[3] = {30, 31, 32};
 /***************************************************/
 //inline bool normalBroadcast = false;
 inline size_t numSentChannels = 0;
-inline uint32_t currentIconPacket = 0;
-inline uint32_t totalIconPackets = 0;
-inline uint32_t sentIconPID = 0;
 inline bool initializing = false;
 // Transitory Variables for passing data around
 /***************************************************/
-inline uint16_t bufferIcon[ICON_SIZE][ICON_SIZE]; // used for passing icon
 inline StaticVector<uint32_t, MAX_PROCESSES> openProcessIDs;
 inline StaticVector<char[NAME_LENGTH_MAX], MAX_PROCESSES> openProcessNames;
 inline ByteArrayQueue<10, PACKET_SIZE> sendingQueue;
@@ -169,7 +124,8 @@ enum SerialCodes {
     ICON_PACKETS_INIT,
     ICON_PACKET,
     THE_ICON_REQUESTED_IS_DEFAULT,
-    BUTTON_PUSHED
+    BUTTON_PUSHED,
+    MULTI_MESSAGE
 };
 
 enum AckType {
@@ -177,23 +133,15 @@ enum AckType {
     CHANNEL_ACK,
 };
 
+// compression of an icon transfer, hosts that predate the codec field send 0
+enum IconCodec : uint8_t {
+    ICON_CODEC_FASTLZ,
+    ICON_CODEC_RLE, // see IconRLE.h
+};
+static constexpr uint8_t SUPPORTED_ICON_CODECS = 1 << ICON_CODEC_FASTLZ | 1 << ICON_CODEC_RLE;
 
-inline struct States {
-    void setReceivingIcon(const bool _receivingIcon) {
-        receivingIcon = _receivingIcon;
-        if (receivingIcon) {
-            currentIconPacket = 0;
-            compressionIndex = 0;
-            compressionSize = 0;
-            totalIconPackets = 0;
-            sentIconPID = 0;
-        }
-    }
-
-    [[nodiscard]] bool isReceivingIcon() const {
-        return receivingIcon;
-    }
 
+inline struct States {
     void setReceivingChannels(const bool _receivingChannels) {
         receivingChannels = _receivingChannels;
         if (!receivingChannels) {
@@ -205,6 +153,5 @@ inline struct States {
         return receivingChannels;
     }
 private:
-    bool receivingIcon = false;
     bool receivingChannels = false;
 } states;
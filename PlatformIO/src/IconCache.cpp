@@ -0,0 +1,92 @@
+#include "IconCache.h"
+#include <Arduino.h>
+
+
+IconCache::IconCache(IconStore *_icons) : icons(_icons) {
+}
+
+IconHandle IconCache::find(const uint32_t pid, const char *name) {
+    for (auto &slot: slots) {
+        if (slot.valid && slot.pid == pid && strncmp(slot.name, name, NAME_LENGTH_MAX) == 0) {
+            stats.hits++;
+            slot.lastUsed = ++useCounter;
+            return slot.icon;
+        }
+    }
+    stats.misses++;
+    return NO_ICON;
+}
+
+void IconCache::store(const uint32_t pid, const char *name, const IconHandle icon) {
+    if (icon == NO_ICON) {
+        return;
+    }
+    Slot &slot = *victim(pid);
+    icons->retain(icon);
+    drop(slot);
+    slot.pid = pid;
+    // names fill the whole field without a terminator when they are NAME_LENGTH_MAX long
+    memset(slot.name, 0, NAME_LENGTH_MAX);
+    memcpy(slot.name, name, strnlen(name, NAME_LENGTH_MAX));
+    slot.icon = icon;
+    slot.lastUsed = ++useCounter;
+    slot.valid = true;
+}
+
+bool IconCache::evictOldest() {
+    Slot *oldest = nullptr;
+    for (auto &slot: slots) {
+        // shown on a channel or built in, dropping it would not give the store a pixel slot back
+        if (!slot.valid || icons->getReferences(slot.icon) > 1 || icons->get(slot.icon) == nullptr) {
+            continue;
+        }
+        if (oldest == nullptr || slot.lastUsed < oldest->lastUsed) {
+            oldest = &slot;
+        }
+    }
+    if (oldest == nullptr) {
+        return false;
+    }
+    stats.evictions++;
+    drop(*oldest);
+    return true;
+}
+
+IconCache::Stats IconCache::getStats() const {
+    return stats;
+}
+
+void IconCache::printStats(Print &out) const {
+    uint8_t used = 0;
+    for (const auto &slot: slots) {
+        used += slot.valid;
+    }
+    out.printf("icon cache %u/%u slots (%u icons free), hits %lu misses %lu evictions %lu\n", used, SLOTS,
+               icons->getFreePixelSlots(), static_cast<unsigned long>(stats.hits),
+               static_cast<unsigned long>(stats.misses), static_cast<unsigned long>(stats.evictions));
+}
+
+// the PID's own slot if it has one (its icon or name changed), else a free slot, else the least recently used
+IconCache::Slot *IconCache::victim(const uint32_t pid) {
+    Slot *oldest = &slots[0];
+    for (auto &slot: slots) {
+        if (slot.valid && slot.pid == pid) {
+            return &slot;
+        }
+        if (oldest->valid && (!slot.valid || slot.lastUsed < oldest->lastUsed)) {
+            oldest = &slot;
+        }
+    }
+    if (oldest->valid) {
+        stats.evictions++;
+    }
+    return oldest;
+}
+
+void IconCache::drop(Slot &slot) {
+    if (slot.valid) {
+        icons->release(slot.icon);
+    }
+    slot.icon = NO_ICON;
+    slot.valid = false;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Globals.h"
+#include "IconStore.h"
+
+/**
+ * @brief Least recently used cache of process icons
+ *
+ * Keyed by PID and process name, so a PID the computer hands to a different program later is a miss rather
+ * than the wrong icon. requestIcon() looks here first and only asks the computer on a miss; every decoded icon
+ * is stored, so switching a fader back to a program it showed before costs no USB traffic at all.
+ *
+ * Entries hold a reference to an icon in the IconStore, so caching an icon that is on screen costs no memory.
+ * Icons only on the cache's side are what evictOldest() gives back when the store runs out of slots; evicting an
+ * icon a channel still shows would free nothing and only lose the entry.
+ */
+class IconCache {
+public:
+    static constexpr uint8_t SLOTS = 24;
+
+    struct Stats {
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t evictions;
+    };
+
+    explicit IconCache(IconStore *_icons);
+
+    ~IconCache() = default;
+
+    /// The cached icon (not retained for the caller), NO_ICON on a miss
+    [[nodiscard]] IconHandle find(uint32_t pid, const char *name);
+
+    void store(uint32_t pid, const char *name, IconHandle icon);
+
+    /// Drops the least recently used entry whose pixel slot nobody else holds, returns false if there is none
+    bool evictOldest();
+
+    [[nodiscard]] Stats getStats() const;
+
+    void printStats(Print &out) const;
+
+private:
+    struct Slot {
+        uint32_t pid = 0;
+        char name[NAME_LENGTH_MAX]{};
+        IconHandle icon = NO_ICON;
+        uint32_t lastUsed = 0;
+        bool valid = false;
+    };
+
+    IconStore *icons;
+    Slot slots[SLOTS];
+    uint32_t useCounter = 0;
+    Stats stats{};
+
+    [[nodiscard]] Slot *victim(uint32_t pid);
+
+    void drop(Slot &slot);
+};
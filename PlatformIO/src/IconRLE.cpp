@@ -0,0 +1,356 @@
+#include "IconRLE.h"
+#include <Arduino.h>
+
+namespace {
+    using namespace IconRLE;
+
+    struct ColourCount {
+        uint16_t colour;
+        uint16_t count;
+    };
+
+    int compareColours(const void *a, const void *b) {
+        return *static_cast<const uint16_t *>(a) - *static_cast<const uint16_t *>(b);
+    }
+
+    int compareCounts(const void *a, const void *b) {
+        return static_cast<const ColourCount *>(b)->count - static_cast<const ColourCount *>(a)->count;
+    }
+
+    uint16_t previous(const uint16_t *pixels, const uint32_t index) {
+        return index == 0 ? 0 : pixels[index - 1];
+    }
+
+    uint32_t runLength(const uint16_t *pixels, const uint32_t index) {
+        const uint16_t colour = previous(pixels, index);
+        uint32_t length = 0;
+        while (index + length < PIXELS && pixels[index + length] == colour) {
+            length++;
+        }
+        return length;
+    }
+
+    uint32_t aboveLength(const uint16_t *pixels, const uint32_t index) {
+        if (index < WIDTH) {
+            return 0;
+        }
+        uint32_t length = 0;
+        while (index + length < PIXELS && pixels[index + length] == pixels[index + length - WIDTH]) {
+            length++;
+        }
+        return length;
+    }
+
+    // pixels neither a run nor the row above would cover, the ones worth a palette entry
+    bool isLiteral(const uint16_t *pixels, const uint32_t index) {
+        return pixels[index] != previous(pixels, index) &&
+               (index < WIDTH || pixels[index] != pixels[index - WIDTH]);
+    }
+
+    // a palette entry costs two bytes once and saves one byte per use
+    uint8_t buildPalette(const uint16_t *pixels, uint16_t palette[MAX_PALETTE]) {
+        auto *literals = static_cast<uint16_t *>(malloc(PIXELS * sizeof(uint16_t)));
+        auto *counts = static_cast<ColourCount *>(malloc(PIXELS * sizeof(ColourCount)));
+        uint32_t literalCount = 0;
+        for (uint32_t i = 0; i < PIXELS; i++) {
+            if (isLiteral(pixels, i)) {
+                literals[literalCount++] = pixels[i];
+            }
+        }
+        qsort(literals, literalCount, sizeof(uint16_t), compareColours);
+        uint32_t colours = 0;
+        for (uint32_t i = 0; i < literalCount; i++) {
+            if (colours > 0 && counts[colours - 1].colour == literals[i]) {
+                counts[colours - 1].count++;
+            } else {
+                counts[colours++] = {literals[i], 1};
+            }
+        }
+        qsort(counts, colours, sizeof(ColourCount), compareCounts);
+        uint8_t size = 0;
+        while (size < MAX_PALETTE && size < colours && counts[size].count >= 3) {
+            palette[size] = counts[size].colour;
+            size++;
+        }
+        free(literals);
+        free(counts);
+        // sorted by colour for the lookups while encoding
+        qsort(palette, size, sizeof(uint16_t), compareColours);
+        return size;
+    }
+
+    int paletteIndex(const uint16_t *palette, const uint8_t size, const uint16_t colour) {
+        const auto *found = static_cast<const uint16_t *>(bsearch(&colour, palette, size, sizeof(uint16_t),
+                                                                  compareColours));
+        return found == nullptr ? -1 : static_cast<int>(found - palette);
+    }
+
+    uint8_t *putToken(uint8_t *op, const Op code, const uint32_t length) {
+        if (length < 64) {
+            *op++ = code << 6 | (length - 1);
+            return op;
+        }
+        *op++ = code << 6 | 63;
+        uint32_t extra = length - 64;
+        do {
+            *op++ = (extra & 127) | (extra >= 128 ? 128 : 0);
+            extra >>= 7;
+        } while (extra > 0);
+        return op;
+    }
+}
+
+uint32_t IconRLE::compress(const uint16_t *pixels, uint8_t *output) {
+    uint16_t palette[MAX_PALETTE];
+    const uint8_t paletteCount = buildPalette(pixels, palette);
+    uint8_t *op = output;
+    *op++ = paletteCount;
+    for (uint8_t i = 0; i < paletteCount; i++) {
+        *op++ = palette[i] & 0xFF;
+        *op++ = palette[i] >> 8;
+    }
+
+    uint32_t i = 0;
+    while (i < PIXELS) {
+        const uint32_t run = runLength(pixels, i);
+        const uint32_t above = aboveLength(pixels, i);
+        if (run >= 2 || above >= 2) {
+            const bool useRun = run >= above;
+            const uint32_t length = useRun ? run : above;
+            op = putToken(op, useRun ? OP_RUN : OP_ABOVE, length);
+            i += length;
+            continue;
+        }
+        // literals of one kind up to where a run or copy of at least two pixels starts
+        const bool inPalette = paletteIndex(palette, paletteCount, pixels[i]) >= 0;
+        uint32_t end = i + 1;
+        while (end < PIXELS && runLength(pixels, end) < 2 && aboveLength(pixels, end) < 2 &&
+               (paletteIndex(palette, paletteCount, pixels[end]) >= 0) == inPalette) {
+            end++;
+        }
+        op = putToken(op, inPalette ? OP_PALETTE : OP_RAW, end - i);
+        for (; i < end; i++) {
+            if (inPalette) {
+                *op++ = paletteIndex(palette, paletteCount, pixels[i]);
+            } else {
+                *op++ = pixels[i] & 0xFF;
+                *op++ = pixels[i] >> 8;
+            }
+        }
+    }
+    return op - output;
+}
+
+bool IconRLE::decompress(const uint8_t *input, const uint32_t length, uint16_t *output) {
+    IconRLEStream decoder;
+    decoder.begin(output, length);
+    return decoder.feed(input, length) == IconRLEStream::Status::DONE;
+}
+
+bool IconRLE::draw(const uint8_t *input, const uint32_t length, const DrawBand drawBand, void *context) {
+    constexpr uint32_t BAND_PIXELS = BAND_ROWS * WIDTH;
+    static_assert(PIXELS % BAND_PIXELS == 0, "icons are drawn in whole bands");
+    if (length == 0 || length < 1u + input[0] * 2u) {
+        return false;
+    }
+    const uint8_t paletteCount = input[0];
+    const uint8_t *palette = input + 1;
+    const uint8_t *ip = palette + paletteCount * 2;
+    const uint8_t *end = input + length;
+    // the last row of the previous band, then the band; black before the first pixel like the stream decoder
+    uint16_t band[WIDTH + BAND_PIXELS];
+    band[WIDTH - 1] = 0;
+    uint32_t position = WIDTH;
+    uint32_t written = 0;
+    auto put = [&](const uint16_t colour) {
+        band[position++] = colour;
+        if (position == WIDTH + BAND_PIXELS) {
+            drawBand(context, (written + 1) / WIDTH - BAND_ROWS, band + WIDTH);
+            memcpy(band, band + BAND_PIXELS, WIDTH * sizeof(uint16_t));
+            position = WIDTH;
+        }
+        written++;
+    };
+
+    while (written < PIXELS) {
+        if (ip == end) {
+            return false;
+        }
+        const auto op = static_cast<Op>(*ip >> 6);
+        uint32_t count = (*ip++ & 63) + 1;
+        if (count == 64) {
+            uint8_t shift = 0;
+            uint8_t value;
+            do {
+                if (ip == end || shift > 14) {
+                    return false;
+                }
+                value = *ip++;
+                count += (value & 127) << shift;
+                shift += 7;
+            } while (value & 128);
+        }
+        const uint32_t inputBytes = op == OP_PALETTE ? count : op == OP_RAW ? count * 2 : 0;
+        if (written + count > PIXELS || (op == OP_ABOVE && written < WIDTH) ||
+            static_cast<uint32_t>(end - ip) < inputBytes) {
+            return false;
+        }
+        switch (op) {
+            case OP_RUN:
+                for (uint32_t i = 0; i < count; i++) {
+                    put(band[position - 1]);
+                }
+                break;
+            case OP_ABOVE:
+                for (uint32_t i = 0; i < count; i++) {
+                    put(band[position - WIDTH]);
+                }
+                break;
+            case OP_PALETTE:
+                for (uint32_t i = 0; i < count; i++) {
+                    const uint8_t index = *ip++;
+                    if (index >= paletteCount) {
+                        return false;
+                    }
+                    put(palette[index * 2] | palette[index * 2 + 1] << 8);
+                }
+                break;
+            case OP_RAW:
+                for (uint32_t i = 0; i < count; i++, ip += 2) {
+                    put(ip[0] | ip[1] << 8);
+                }
+                break;
+        }
+    }
+    return ip == end;
+}
+
+void IconRLEStream::begin(uint16_t *_output, const uint32_t inputSize) {
+    output = _output;
+    produced = 0;
+    inputLeft = inputSize;
+    count = 0;
+    paletteCount = 0;
+    state = State::PALETTE_COUNT;
+    status = output != nullptr && inputSize > 0 ? Status::RUNNING : Status::ERROR;
+}
+
+IconRLEStream::Status IconRLEStream::feed(const uint8_t *input, uint32_t length) {
+    if (status != Status::RUNNING) {
+        return status;
+    }
+    length = min(length, inputLeft);
+    inputLeft -= length;
+    const uint8_t *ip = input;
+    const uint8_t *end = input + length;
+    while (ip < end) {
+        const uint8_t value = *ip++;
+        switch (state) {
+            case State::PALETTE_COUNT:
+                paletteCount = value;
+                count = value;
+                state = count > 0 ? State::PALETTE_LOW : State::TOKEN;
+                break;
+            case State::PALETTE_LOW:
+                low = value;
+                state = State::PALETTE_HIGH;
+                break;
+            case State::PALETTE_HIGH:
+                palette[paletteCount - count] = low | value << 8;
+                state = --count > 0 ? State::PALETTE_LOW : State::TOKEN;
+                break;
+            case State::TOKEN:
+                op = static_cast<IconRLE::Op>(value >> 6);
+                count = (value & 63) + 1;
+                if (count == 64) {
+                    shift = 0;
+                    state = State::LENGTH;
+                } else if (!startToken()) {
+                    return status;
+                }
+                break;
+            case State::LENGTH:
+                count += (value & 127) << shift;
+                shift += 7;
+                if (value & 128) {
+                    if (shift > 14) {
+                        fail();
+                        return status;
+                    }
+                } else if (!startToken()) {
+                    return status;
+                }
+                break;
+            case State::INDEXES:
+                if (value >= paletteCount) {
+                    fail();
+                    return status;
+                }
+                output[produced++] = palette[value];
+                if (--count == 0) {
+                    state = State::TOKEN;
+                }
+                break;
+            case State::RAW_LOW:
+                low = value;
+                state = State::RAW_HIGH;
+                break;
+            case State::RAW_HIGH:
+                output[produced++] = low | value << 8;
+                state = --count > 0 ? State::RAW_LOW : State::TOKEN;
+                break;
+        }
+    }
+    if (inputLeft == 0) {
+        status = state == State::TOKEN && produced == IconRLE::PIXELS ? Status::DONE : Status::ERROR;
+    }
+    return status;
+}
+
+IconRLEStream::Status IconRLEStream::getStatus() const {
+    return status;
+}
+
+uint32_t IconRLEStream::getOutputLength() const {
+    return produced;
+}
+
+// runs and copies are written as soon as their length is known, literals as their bytes arrive
+bool IconRLEStream::startToken() {
+    if (produced + count > IconRLE::PIXELS) {
+        fail();
+        return false;
+    }
+    switch (op) {
+        case IconRLE::OP_RUN: {
+            const uint16_t colour = produced == 0 ? 0 : output[produced - 1];
+            for (uint32_t i = 0; i < count; i++) {
+                output[produced++] = colour;
+            }
+            state = State::TOKEN;
+            break;
+        }
+        case IconRLE::OP_ABOVE:
+            if (produced < IconRLE::WIDTH) {
+                fail();
+                return false;
+            }
+            // forward, a copy longer than a row repeats what it just wrote
+            for (uint32_t i = 0; i < count; i++, produced++) {
+                output[produced] = output[produced - IconRLE::WIDTH];
+            }
+            state = State::TOKEN;
+            break;
+        case IconRLE::OP_PALETTE:
+            state = State::INDEXES;
+            break;
+        case IconRLE::OP_RAW:
+            state = State::RAW_LOW;
+            break;
+    }
+    return true;
+}
+
+void IconRLEStream::fail() {
+    status = Status::ERROR;
+}
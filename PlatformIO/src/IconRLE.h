@@ -0,0 +1,109 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Icon codec built for 128x128 RGB565 icons: a small palette, runs and copies from the row above
+ *
+ * Icons are mostly black background and flat colour areas with anti-aliased edges, so almost every pixel is
+ * either the same as its left neighbour, the same as the one above, or one of a few hundred colours.
+ *
+ * Stream layout (all 16 bit values little endian):
+ * [PALETTE_COUNT 1B][PALETTE COLOUR 2B x PALETTE_COUNT] then tokens until every pixel is written
+ *
+ * Token: [OP 2 bits][N 6 bits] then, if N is 63, an unsigned LEB128 EXTRA; the token covers LENGTH pixels,
+ * N + 1 for N < 63 and 64 + EXTRA otherwise.
+ *   OP_RUN     LENGTH copies of the previous pixel (black before the first one)
+ *   OP_ABOVE   LENGTH pixels copied from the row above, not allowed in the first row
+ *   OP_PALETTE followed by LENGTH palette indexes, 1B each
+ *   OP_RAW     followed by LENGTH colours, 2B each
+ * Tokens may run on past the end of a row, pixels are addressed in row-major order.
+ */
+namespace IconRLE {
+    static constexpr uint8_t WIDTH = 128;
+    static constexpr uint16_t PIXELS = WIDTH * 128;
+    static constexpr uint16_t MAX_PALETTE = 255;
+
+    enum Op : uint8_t {
+        OP_RUN,
+        OP_ABOVE,
+        OP_PALETTE,
+        OP_RAW,
+    };
+
+    /// Full palette, then palette and raw pixels alternating in tokens of one
+    static constexpr uint32_t MAX_COMPRESSED = 1 + MAX_PALETTE * 2 + PIXELS * 3;
+
+    /// Rows handed to a DrawBand at a time
+    static constexpr uint8_t BAND_ROWS = 8;
+
+    /// Receives BAND_ROWS full rows of pixels starting at firstRow
+    using DrawBand = void (*)(void *context, uint8_t firstRow, const uint16_t *pixels);
+
+    /// Encodes PIXELS row-major pixels, output needs MAX_COMPRESSED bytes, returns the compressed length
+    uint32_t compress(const uint16_t *pixels, uint8_t *output);
+
+    /// Decodes a whole stream into PIXELS pixels, returns false on corrupt input
+    bool decompress(const uint8_t *input, uint32_t length, uint16_t *output);
+
+    /// Decodes a whole stream that stays readable in place (a built-in icon in flash) without an icon sized
+    /// buffer, only the band being decoded and the row above it. Returns false on corrupt input, the bands before
+    /// the error have been drawn.
+    bool draw(const uint8_t *input, uint32_t length, DrawBand drawBand, void *context);
+}
+
+/**
+ * @brief Incremental IconRLE decoder, same interface as FastLZStream
+ *
+ * Takes the stream in pieces of any size and writes pixels straight into the destination icon. Corrupt input
+ * ends in ERROR without writing outside the icon.
+ */
+class IconRLEStream {
+public:
+    enum class Status : uint8_t {
+        RUNNING,
+        DONE,
+        ERROR,
+    };
+
+    IconRLEStream() = default;
+
+    ~IconRLEStream() = default;
+
+    void begin(uint16_t *output, uint32_t inputSize);
+
+    /// Bytes past the announced input size (packet padding) are ignored
+    Status feed(const uint8_t *input, uint32_t length);
+
+    [[nodiscard]] Status getStatus() const;
+
+    [[nodiscard]] uint32_t getOutputLength() const;
+
+private:
+    enum class State : uint8_t {
+        PALETTE_COUNT,
+        PALETTE_LOW,
+        PALETTE_HIGH,
+        TOKEN,
+        LENGTH, // LEB128 extra length
+        INDEXES,
+        RAW_LOW,
+        RAW_HIGH,
+    };
+
+    uint16_t *output = nullptr;
+    uint16_t palette[IconRLE::MAX_PALETTE]{};
+    uint32_t produced = 0;
+    uint32_t inputLeft = 0;
+    uint32_t count = 0; // palette entries or pixels left in the current token
+    uint8_t shift = 0; // of the next LEB128 group
+    uint8_t paletteCount = 0;
+    uint8_t low = 0; // first byte of a 16 bit value
+    IconRLE::Op op = IconRLE::OP_RUN;
+    State state = State::PALETTE_COUNT;
+    Status status = Status::ERROR;
+
+    bool startToken();
+
+    void fail();
+};
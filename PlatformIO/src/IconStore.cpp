@@ -0,0 +1,107 @@
+#include "IconStore.h"
+#include <Arduino.h>
+
+
+IconStore::IconStore(MemoryArena *_psram, MemoryArena *_ram2) {
+    psram = _psram;
+    ram2 = _ram2;
+}
+
+bool IconStore::begin() {
+    // RAM2 cannot spare 1 MB, see FALLBACK_PIXEL_SLOTS
+    if (!psram->isReady() || pixels.begin(psram, PIXEL_SLOTS, CHANNELS, "icon store") == 0) {
+        pixels.begin(ram2, FALLBACK_PIXEL_SLOTS, CHANNELS, "icon store");
+    }
+    for (uint8_t slot = 0; slot < PIXEL_SLOTS; slot++) {
+        slots[slot].storage = pixels.get(slot);
+    }
+    return pixels.getCount() >= CHANNELS;
+}
+
+IconHandle IconStore::acquire() {
+    const uint8_t slot = pixels.acquire();
+    if (slot == PixelPool::NO_BLOCK) {
+        return NO_ICON;
+    }
+    slots[slot].references = 1;
+    return slot;
+}
+
+IconHandle IconStore::wrap(const BuiltinIcon &icon) {
+    IconHandle free = NO_ICON;
+    for (uint8_t slot = PIXEL_SLOTS; slot < SLOTS; slot++) {
+        if (slots[slot].references > 0 && slots[slot].builtin.rle == icon.rle) {
+            slots[slot].references++;
+            return slot;
+        }
+        if (slots[slot].references == 0 && free == NO_ICON) {
+            free = slot;
+        }
+    }
+    if (free != NO_ICON) {
+        slots[free].builtin = icon;
+        slots[free].references = 1;
+    }
+    return free;
+}
+
+void IconStore::retain(const IconHandle handle) {
+    if (isValid(handle)) {
+        slots[handle].references++;
+    }
+}
+
+void IconStore::release(const IconHandle handle) {
+    if (isValid(handle) && --slots[handle].references == 0 && handle < PIXEL_SLOTS) {
+        pixels.release(handle);
+    }
+}
+
+uint8_t IconStore::getReferences(const IconHandle handle) const {
+    return isValid(handle) ? slots[handle].references : 0;
+}
+
+const uint16_t *IconStore::get(const IconHandle handle) const {
+    if (!isValid(handle)) {
+        return nullptr;
+    }
+    return handle < PIXEL_SLOTS ? slots[handle].storage : nullptr;
+}
+
+const BuiltinIcon *IconStore::getBuiltin(const IconHandle handle) const {
+    if (!isValid(handle) || handle < PIXEL_SLOTS) {
+        return nullptr;
+    }
+    return &slots[handle].builtin;
+}
+
+uint16_t *IconStore::getWritable(const IconHandle handle) const {
+    if (!isValid(handle) || handle >= PIXEL_SLOTS) {
+        return nullptr;
+    }
+    return slots[handle].storage;
+}
+
+uint8_t IconStore::getPixelSlots() const {
+    return pixels.getCount();
+}
+
+uint8_t IconStore::getFreePixelSlots() const {
+    return pixels.getCount() - pixels.getInUse();
+}
+
+uint8_t IconStore::getPixelSlotsHighWater() const {
+    return pixels.getHighWater();
+}
+
+size_t IconStore::getBytesAllocated() const {
+    return pixels.getCount() * ICON_BYTES;
+}
+
+const void *IconStore::getStorage() const {
+    return pixels.get(0);
+}
+
+bool IconStore::isValid(const IconHandle handle) const {
+    return handle < SLOTS && slots[handle].references > 0;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Globals.h"
+#include "BlockPool.h"
+#include "MemoryArena.h"
+
+/// Index of an icon in the IconStore, NO_ICON when a channel shows none
+using IconHandle = uint8_t;
+static constexpr IconHandle NO_ICON = UINT8_MAX;
+
+/// A built-in icon, IconRLE compressed in flash (tools/builtin_icons.py generates icons.h)
+struct BuiltinIcon {
+    const uint8_t *rle;
+    uint32_t length;
+};
+
+/**
+ * @brief Reference counted pool of 128x128 icons shared by the channels and the icon cache
+ *
+ * Channels and cache entries only hold handles, so showing the same icon on several channels, handing a channel
+ * the default icon or taking one out of the cache is a reference count change instead of a 32 KB copy.
+ *
+ * acquire() and wrap() return a handle with one reference that belongs to the caller, every retain() needs a
+ * matching release() and a slot goes back to the pool when its last reference is dropped. Pixel slots come from
+ * the PSRAM arena; without PSRAM only FALLBACK_PIXEL_SLOTS are taken from RAM2.
+ * Built-in icons are wrapped rather than decompressed into a slot, they are drawn straight from flash.
+ */
+class IconStore {
+public:
+    static constexpr uint8_t PIXEL_SLOTS = 32;
+    /// Without PSRAM: one slot per fader channel (the master shows a built-in icon) and two for icons being received
+    static constexpr uint8_t FALLBACK_PIXEL_SLOTS = (CHANNELS - FIRST_CHANNEL) + 2;
+    static constexpr uint8_t SHARED_SLOTS = 4;
+    static constexpr size_t ICON_BYTES = ICON_SIZE * ICON_SIZE * sizeof(uint16_t);
+
+    IconStore(MemoryArena *_psram, MemoryArena *_ram2);
+
+    ~IconStore() = default;
+
+    /// Returns true if at least one pixel slot per channel could be allocated
+    bool begin();
+
+    /// A free slot to write an icon into, NO_ICON if every slot is referenced
+    [[nodiscard]] IconHandle acquire();
+
+    /// Shares a built-in icon, wrapping the same icon twice shares the slot
+    [[nodiscard]] IconHandle wrap(const BuiltinIcon &icon);
+
+    void retain(IconHandle handle);
+
+    void release(IconHandle handle);
+
+    /// How many holders share the icon, 0 for NO_ICON
+    [[nodiscard]] uint8_t getReferences(IconHandle handle) const;
+
+    /// Row-major RGB565 pixels, nullptr for NO_ICON and built-in icons
+    [[nodiscard]] const uint16_t *get(IconHandle handle) const;
+
+    /// The compressed icon of a handle from wrap(), nullptr otherwise
+    [[nodiscard]] const BuiltinIcon *getBuiltin(IconHandle handle) const;
+
+    /// Only valid for handles from acquire()
+    [[nodiscard]] uint16_t *getWritable(IconHandle handle) const;
+
+    [[nodiscard]] uint8_t getPixelSlots() const;
+
+    [[nodiscard]] uint8_t getFreePixelSlots() const;
+
+    /// Most pixel slots held at once since boot
+    [[nodiscard]] uint8_t getPixelSlotsHighWater() const;
+
+    [[nodiscard]] size_t getBytesAllocated() const;
+
+    [[nodiscard]] const void *getStorage() const;
+
+private:
+    struct Slot {
+        uint16_t *storage = nullptr;
+        BuiltinIcon builtin{};
+        uint8_t references = 0;
+    };
+
+    static constexpr uint8_t SLOTS = PIXEL_SLOTS + SHARED_SLOTS;
+
+    using PixelPool = BlockPool<uint16_t, ICON_SIZE * ICON_SIZE>;
+
+    MemoryArena *psram;
+    MemoryArena *ram2;
+    PixelPool pixels;
+    Slot slots[SLOTS];
+
+    [[nodiscard]] bool isValid(IconHandle handle) const;
+};
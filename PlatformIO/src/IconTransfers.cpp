@@ -0,0 +1,171 @@
+#include "IconTransfers.h"
+#include <Arduino.h>
+#include "Profiler.h"
+#include "packets/RecIconPacketInit.h"
+#include "packets/RecIconPacket.h"
+
+// first API version whose icon packets carry transfer IDs and indexes
+static constexpr uint8_t TRANSFER_API_VERSION = 3;
+
+
+IconTransfers::IconTransfers(IconStore *_icons, const NewIconFunction _newIcon, const FinishedFunction _finished,
+                             const AckFunction _ack) {
+    icons = _icons;
+    newIcon = _newIcon;
+    finished = _finished;
+    ack = _ack;
+}
+
+void IconTransfers::begin(const uint8_t _window) {
+    for (auto &receiver: receivers) {
+        close(receiver);
+    }
+    window = constrain(_window, static_cast<uint8_t>(1), WINDOW);
+}
+
+bool IconTransfers::open(const uint8_t buf[PACKET_SIZE]) {
+    const RecIconPacketInit init(buf);
+    const bool legacy = init.getVersion() < TRANSFER_API_VERSION;
+    const uint8_t transfer = legacy ? 0 : init.getTransfer() % TRANSFER_IDS;
+    // the computer gave up on the transfer and starts it over
+    Receiver *receiver = find(transfer);
+    if (receiver != nullptr) {
+        stats.abandoned++;
+        close(*receiver);
+    }
+    for (uint8_t i = 0; i < window && receiver == nullptr; i++) {
+        if (!receivers[i].open) {
+            receiver = &receivers[i];
+        }
+    }
+    if (receiver == nullptr) {
+        return false;
+    }
+    receiver->open = true;
+    receiver->legacy = legacy;
+    receiver->transfer = transfer;
+    receiver->codec = init.getCodec();
+    receiver->pid = init.getPID();
+    receiver->packets = init.getPacketCount();
+    receiver->received = 0;
+    receiver->resumeRequested = false;
+    if (receiver->codec != ICON_CODEC_FASTLZ && receiver->codec != ICON_CODEC_RLE) {
+        Serial.println("Error: Unknown icon codec " + String(receiver->codec));
+    } else {
+        receiver->icon = newIcon();
+        if (receiver->icon == NO_ICON) {
+            Serial.println("Error: No free icon slot");
+        }
+    }
+    uint16_t *pixels = icons->getWritable(receiver->icon);
+    if (receiver->codec == ICON_CODEC_RLE) {
+        receiver->rle.begin(pixels, init.getByteCount());
+    } else {
+        receiver->fastlz.begin(reinterpret_cast<uint8_t *>(pixels), IconStore::ICON_BYTES, init.getByteCount());
+    }
+    stats.openHighWater = max(stats.openHighWater, static_cast<uint8_t>(window - getFreeTransfers()));
+    // ready for the first packet
+    acknowledge(*receiver, buf[PacketPositions::Base::COUNT_INDEX]);
+    if (receiver->packets == 0) {
+        finish(*receiver);
+    }
+    return true;
+}
+
+void IconTransfers::packet(const uint8_t buf[PACKET_SIZE]) {
+    const RecIconPacket packet(buf);
+    const bool legacy = packet.getVersion() < TRANSFER_API_VERSION;
+    Receiver *receiver = find(legacy ? 0 : packet.getTransfer());
+    if (receiver == nullptr) {
+        stats.dropped++;
+        return;
+    }
+    if (!receiver->legacy && packet.getSequence() != receiver->received) {
+        // one ack per gap is enough, the packets after it are dropped until the resent one arrives
+        stats.dropped++;
+        if (!receiver->resumeRequested) {
+            receiver->resumeRequested = true;
+            acknowledge(*receiver, buf[PacketPositions::Base::COUNT_INDEX]);
+        }
+        return;
+    }
+    {
+        ProfileScope profile(Profiler::DECOMPRESS);
+        if (receiver->codec == ICON_CODEC_RLE) {
+            receiver->rle.feed(packet.getIconData(), RecIconPacket::getIconDataLength());
+        } else {
+            receiver->fastlz.feed(packet.getIconData(), RecIconPacket::getIconDataLength());
+        }
+    }
+    receiver->received++;
+    receiver->resumeRequested = false;
+    if (receiver->received == receiver->packets) {
+        finish(*receiver);
+    } else if (!receiver->legacy && receiver->received % ACK_INTERVAL == 0) {
+        acknowledge(*receiver, buf[PacketPositions::Base::COUNT_INDEX]);
+    }
+}
+
+bool IconTransfers::isReceiving() const {
+    return getFreeTransfers() < window;
+}
+
+uint8_t IconTransfers::getFreeTransfers() const {
+    uint8_t free = 0;
+    for (uint8_t i = 0; i < window; i++) {
+        free += !receivers[i].open;
+    }
+    return free;
+}
+
+IconTransfers::Stats IconTransfers::getStats() const {
+    return stats;
+}
+
+void IconTransfers::printStats(Print &out) const {
+    out.printf("icon transfers %u/%u open (high water %u), completed %lu failed %lu abandoned %lu, "
+               "dropped packets %lu\n", window - getFreeTransfers(), window, stats.openHighWater,
+               static_cast<unsigned long>(stats.completed), static_cast<unsigned long>(stats.failed),
+               static_cast<unsigned long>(stats.abandoned), static_cast<unsigned long>(stats.dropped));
+}
+
+IconTransfers::Receiver *IconTransfers::find(const uint8_t transfer) {
+    for (uint8_t i = 0; i < window; i++) {
+        if (receivers[i].open && receivers[i].transfer == transfer) {
+            return &receivers[i];
+        }
+    }
+    return nullptr;
+}
+
+// the receiver is free again before the last ack goes out, so the computer can open the next transfer right away
+void IconTransfers::finish(Receiver &receiver) {
+    const bool decoded = receiver.codec == ICON_CODEC_RLE
+                             ? receiver.rle.getStatus() == IconRLEStream::Status::DONE
+                             : receiver.fastlz.getStatus() == FastLZStream::Status::DONE;
+    const IconHandle icon = receiver.icon;
+    receiver.icon = NO_ICON;
+    close(receiver);
+    if (!receiver.legacy) {
+        acknowledge(receiver, static_cast<uint8_t>(receiver.received));
+    }
+    if (icon == NO_ICON || !decoded) {
+        stats.failed++;
+    } else {
+        stats.completed++;
+    }
+    if (icon != NO_ICON) {
+        finished(receiver.pid, icon, decoded);
+        icons->release(icon);
+    }
+}
+
+void IconTransfers::close(Receiver &receiver) {
+    icons->release(receiver.icon);
+    receiver.icon = NO_ICON;
+    receiver.open = false;
+}
+
+void IconTransfers::acknowledge(const Receiver &receiver, const uint8_t ackPacket) const {
+    ack(ackPacket, receiver.transfer, receiver.received, getFreeTransfers());
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Globals.h"
+#include "IconStore.h"
+#include "FastLZStream.h"
+#include "IconRLE.h"
+
+/**
+ * @brief Receives up to WINDOW icons at once, each decompressed as its packets arrive
+ *
+ * The computer gives every icon transfer an ID in ICON_PACKETS_INIT and may open more transfers before the
+ * earlier ones are done, interleaving their ICON_PACKETs so the USB pipe never waits on a round trip. Every open
+ * transfer has its own decoder writing into its own icon slot.
+ *
+ * Packets carry their index within the transfer. One that is not the next expected is dropped, and the
+ * cumulative ack sent for it tells the computer where to resume. Acks also go out when a transfer opens, every
+ * ACK_INTERVAL packets and when it is complete, each with the number of transfers the computer may still open.
+ *
+ * Hosts before API version 3 send one icon at a time without IDs or indexes; their transfer only gets the ack
+ * for its init, as before.
+ */
+class IconTransfers {
+public:
+    static constexpr uint8_t WINDOW = 4;
+    static constexpr uint8_t TRANSFER_IDS = 16;
+    static constexpr uint16_t ACK_INTERVAL = 16;
+
+    struct Stats {
+        uint32_t completed;
+        uint32_t failed; // not decoded, or no icon slot
+        uint32_t abandoned; // reopened by the computer before they were complete
+        uint32_t dropped; // packets out of order or for no open transfer
+        uint8_t openHighWater;
+    };
+
+    using NewIconFunction = IconHandle (*)();
+    /// icon is only valid for the call, decoded is false if the stream was corrupt
+    using FinishedFunction = void (*)(uint32_t pid, IconHandle icon, bool decoded);
+    using AckFunction = void (*)(uint8_t ackPacket, uint8_t transfer, uint16_t received, uint8_t freeTransfers);
+
+    IconTransfers(IconStore *_icons, NewIconFunction _newIcon, FinishedFunction _finished, AckFunction _ack);
+
+    ~IconTransfers() = default;
+
+    /// How many transfers may be open at once, at most WINDOW
+    void begin(uint8_t _window);
+
+    /// Handles ICON_PACKETS_INIT, false if every receiver is busy and the packet has to wait
+    bool open(const uint8_t buf[PACKET_SIZE]);
+
+    /// Handles ICON_PACKET
+    void packet(const uint8_t buf[PACKET_SIZE]);
+
+    [[nodiscard]] bool isReceiving() const;
+
+    [[nodiscard]] uint8_t getFreeTransfers() const;
+
+    [[nodiscard]] Stats getStats() const;
+
+    void printStats(Print &out) const;
+
+private:
+    struct Receiver {
+        bool open = false;
+        bool legacy = false;
+        bool resumeRequested = false; // acked a gap, waiting for the resent packet
+        uint8_t transfer = 0;
+        uint8_t codec = ICON_CODEC_FASTLZ;
+        uint32_t pid = 0;
+        uint32_t packets = 0;
+        uint16_t received = 0;
+        IconHandle icon = NO_ICON;
+        FastLZStream fastlz;
+        IconRLEStream rle;
+    };
+
+    IconStore *icons;
+    NewIconFunction newIcon;
+    FinishedFunction finished;
+    AckFunction ack;
+    Receiver receivers[WINDOW];
+    uint8_t window = 1;
+    Stats stats{};
+
+    [[nodiscard]] Receiver *find(uint8_t transfer);
+
+    void finish(Receiver &receiver);
+
+    void close(Receiver &receiver);
+
+    void acknowledge(const Receiver &receiver, uint8_t ackPacket) const;
+};
@@ -0,0 +1,81 @@
+#include "MemoryArena.h"
+#include <Arduino.h>
+
+
+MemoryArena::MemoryArena(const char *_name) {
+    name = _name;
+}
+
+bool MemoryArena::begin(void *memory, const size_t size) {
+    if (memory == nullptr || sm_set_pool(&pool, memory, size, 0, nullptr) == 0) {
+        return false;
+    }
+    stats = {size, 0, 0, 0};
+    return true;
+}
+
+bool MemoryArena::isReady() const {
+    return pool.pool != nullptr;
+}
+
+void *MemoryArena::allocate(const size_t bytes, const char *owner) {
+    Allocation *free = nullptr;
+    for (auto &allocation: allocations) {
+        if (allocation.block == nullptr) {
+            free = &allocation;
+            break;
+        }
+    }
+    void *block = free == nullptr || !isReady() ? nullptr : sm_malloc_pool(&pool, bytes);
+    if (block == nullptr) {
+        stats.failures++;
+        return nullptr;
+    }
+    *free = {block, bytes, owner};
+    stats.inUse += bytes;
+    stats.highWater = max(stats.highWater, stats.inUse);
+    return block;
+}
+
+void MemoryArena::release(void *block) {
+    if (block == nullptr) {
+        return;
+    }
+    for (auto &allocation: allocations) {
+        if (allocation.block == block) {
+            sm_free_pool(&pool, block);
+            stats.inUse -= allocation.bytes;
+            allocation = {};
+            return;
+        }
+    }
+}
+
+bool MemoryArena::contains(const void *block) const {
+    const auto *start = static_cast<const uint8_t *>(pool.pool);
+    const auto *address = static_cast<const uint8_t *>(block);
+    return start != nullptr && address >= start && address < start + pool.pool_size;
+}
+
+MemoryArena::Stats MemoryArena::getStats() const {
+    return stats;
+}
+
+const char *MemoryArena::getName() const {
+    return name;
+}
+
+void MemoryArena::printStats(Print &out) const {
+    if (!isReady()) {
+        out.printf("%s arena: not available\n", name);
+        return;
+    }
+    out.printf("%s arena: %lu/%lu B in use, high water %lu B, %lu failed\n", name,
+               static_cast<unsigned long>(stats.inUse), static_cast<unsigned long>(stats.size),
+               static_cast<unsigned long>(stats.highWater), static_cast<unsigned long>(stats.failures));
+    for (const auto &allocation: allocations) {
+        if (allocation.block != nullptr) {
+            out.printf("  %-16s %8lu B\n", allocation.owner, static_cast<unsigned long>(allocation.bytes));
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+#include "smalloc.h"
+
+/**
+ * @brief A heap in one memory region (PSRAM, RAM2) that knows who holds what
+ *
+ * An smalloc pool over one block handed to begin(), so the buffers placed in a region come out of a budget set
+ * at boot instead of each subsystem calling malloc() or extmem_malloc() on its own. Every allocation names its
+ * owner; the arena keeps them with their sizes, the high-water mark and the failed requests for printStats().
+ *
+ * allocate() and release() must be paired by the owner, blocks are not moved or reclaimed behind its back.
+ */
+class MemoryArena {
+public:
+    static constexpr uint8_t MAX_ALLOCATIONS = 16;
+
+    struct Stats {
+        size_t size;
+        size_t inUse;
+        size_t highWater;
+        uint32_t failures;
+    };
+
+    explicit MemoryArena(const char *_name);
+
+    ~MemoryArena() = default;
+
+    /// Takes over size bytes at memory, false if there is none
+    bool begin(void *memory, size_t size);
+
+    [[nodiscard]] bool isReady() const;
+
+    /// nullptr if the arena is not set up, has no room or already tracks MAX_ALLOCATIONS blocks
+    [[nodiscard]] void *allocate(size_t bytes, const char *owner);
+
+    /// Blocks this arena did not hand out are ignored
+    void release(void *block);
+
+    [[nodiscard]] bool contains(const void *block) const;
+
+    [[nodiscard]] Stats getStats() const;
+
+    [[nodiscard]] const char *getName() const;
+
+    /// One line of totals, then a line per live allocation
+    void printStats(Print &out) const;
+
+private:
+    struct Allocation {
+        void *block = nullptr;
+        size_t bytes = 0;
+        const char *owner = nullptr;
+    };
+
+    const char *name;
+    smalloc_pool pool{};
+    Allocation allocations[MAX_ALLOCATIONS];
+    Stats stats{};
+};
@@ -0,0 +1,97 @@
+#include "MuxManager.h"
+#include <Arduino.h>
+#include "Profiler.h"
+
+
+void MuxManager::begin() {
+    setupBus(buses[POT], potMuxPins);
+    setupBus(buses[TOUCH], touchMuxPins);
+    setupBus(buses[CS], csMuxPins);
+}
+
+void MuxManager::select(const Bus bus, const uint8_t channel) {
+    ProfileScope profile(Profiler::MUX_SWITCH);
+    BusState &state = buses[bus];
+    const uint8_t changed = (state.channel ^ channel) & (ADDRESSES - 1);
+    if (changed == 0) {
+        state.current.switchesAvoided++;
+        return;
+    }
+    for (uint8_t i = 0; i < state.portCount; i++) {
+        if (const uint32_t mask = state.ports[i].masks[changed]; mask != 0) {
+            *state.ports[i].toggle = mask;
+        }
+    }
+    state.channel = channel;
+    state.switchedAt = ARM_DWT_CYCCNT;
+    state.current.switches++;
+}
+
+void MuxManager::waitSettled(const Bus bus) {
+    const BusState &state = buses[bus];
+    const uint32_t settleCycles = SETTLE_MICROS[bus] * (F_CPU / 1000000);
+    const uint32_t start = ARM_DWT_CYCCNT;
+    if (start - state.switchedAt >= settleCycles) {
+        return;
+    }
+    while (ARM_DWT_CYCCNT - state.switchedAt < settleCycles) {
+    }
+    buses[bus].current.settleMicros += (ARM_DWT_CYCCNT - start) / (F_CPU / 1000000);
+}
+
+uint8_t MuxManager::getChannel(const Bus bus) const {
+    return buses[bus].channel;
+}
+
+MuxManager::Stats MuxManager::getLoopStats(const Bus bus) const {
+    noInterrupts();
+    const Stats stats = buses[bus].lastLoop;
+    interrupts();
+    return stats;
+}
+
+void MuxManager::endLoop() {
+    noInterrupts();
+    for (auto &state: buses) {
+        state.lastLoop = state.current;
+        state.current = {};
+    }
+    interrupts();
+}
+
+void MuxManager::printStats(Print &out) const {
+    for (uint8_t bus = 0; bus < BUS_COUNT; bus++) {
+        const Stats stats = getLoopStats(static_cast<Bus>(bus));
+        out.printf("mux %-5s switches %lu avoided %lu settle %lu us (last loop)\n", BUS_NAMES[bus],
+                   static_cast<unsigned long>(stats.switches), static_cast<unsigned long>(stats.switchesAvoided),
+                   static_cast<unsigned long>(stats.settleMicros));
+    }
+}
+
+// drive every pin of the bus low, then group the pins by GPIO port so a switch is one toggle write per port
+void MuxManager::setupBus(BusState &state, const uint8_t pins[ADDRESS_BITS]) {
+    state.portCount = 0;
+    for (uint8_t bit = 0; bit < ADDRESS_BITS; bit++) {
+        pinMode(pins[bit], OUTPUT);
+        digitalWrite(pins[bit], LOW);
+
+        volatile uint32_t *toggle = portToggleRegister(pins[bit]);
+        Port *port = nullptr;
+        for (uint8_t i = 0; i < state.portCount; i++) {
+            if (state.ports[i].toggle == toggle) {
+                port = &state.ports[i];
+            }
+        }
+        if (port == nullptr) {
+            port = &state.ports[state.portCount++];
+            port->toggle = toggle;
+        }
+        for (uint8_t changed = 0; changed < ADDRESSES; changed++) {
+            if (bitRead(changed, bit)) {
+                port->masks[changed] |= digitalPinToBitMask(pins[bit]);
+            }
+        }
+    }
+    state.channel = 0;
+    state.switchedAt = ARM_DWT_CYCCNT;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Globals.h"
+
+/**
+ * @brief Owner of the three 3-bit mux address buses (pot, touch and CS)
+ *
+ * Remembers the address each bus is on, so selecting the channel a bus already points at costs nothing. A
+ * switch is a single write per GPIO port through the toggle register, which never disturbs the other pins on
+ * that port (the pot and touch buses are switched from interrupts and share ports with the CS bus).
+ *
+ * Every bus settles on its own clock: select() stamps the switch and waitSettled() only waits for whatever
+ * part of the settle time has not already passed, so a bus switched early settles while other work happens.
+ * Each bus is only ever selected from one context.
+ */
+class MuxManager {
+public:
+    enum Bus : uint8_t {
+        POT,
+        TOUCH,
+        CS,
+        BUS_COUNT
+    };
+
+    struct Stats {
+        uint32_t switches;
+        /// Selects that asked for the address the bus was already on
+        uint32_t switchesAvoided;
+        /// Time spent inside waitSettled()
+        uint32_t settleMicros;
+    };
+
+    MuxManager() = default;
+
+    ~MuxManager() = default;
+
+    void begin();
+
+    void select(Bus bus, uint8_t channel);
+
+    void waitSettled(Bus bus);
+
+    [[nodiscard]] uint8_t getChannel(Bus bus) const;
+
+    /// Totals for the last loop() pass, latched by endLoop()
+    [[nodiscard]] Stats getLoopStats(Bus bus) const;
+
+    void endLoop();
+
+    /// The last loop() pass of every bus
+    void printStats(Print &out) const;
+
+private:
+    static constexpr uint8_t ADDRESS_BITS = 3;
+    static constexpr uint8_t ADDRESSES = 1 << ADDRESS_BITS;
+    static constexpr uint32_t SETTLE_MICROS[BUS_COUNT] = {50, 50, 1};
+    static constexpr const char *BUS_NAMES[BUS_COUNT] = {"pot", "touch", "cs"};
+
+    struct Port {
+        volatile uint32_t *toggle = nullptr;
+        /// Pins to toggle for each combination of changed address bits
+        uint32_t masks[ADDRESSES]{};
+    };
+
+    struct BusState {
+        Port ports[ADDRESS_BITS];
+        uint8_t portCount = 0;
+        volatile uint8_t channel = 0;
+        uint32_t switchedAt = 0;
+        Stats current{};
+        Stats lastLoop{};
+    };
+
+    BusState buses[BUS_COUNT];
+
+    void setupBus(BusState &state, const uint8_t pins[ADDRESS_BITS]);
+};
+
+inline MuxManager muxManager;
+
+inline void selectPotMux(const uint8_t channel) {
+    muxManager.select(MuxManager::POT, channel);
+}
+
+inline void selectTouchMux(const uint8_t channel) {
+    muxManager.select(MuxManager::TOUCH, channel);
+}
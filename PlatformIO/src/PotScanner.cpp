@@ -0,0 +1,52 @@
+#include "PotScanner.h"
+#include <Arduino.h>
+
+
+PotScanner::PotScanner(const SelectChannelFunction _selectChannel, const StartConversionFunction _startConversion) {
+    selectChannel = _selectChannel;
+    startConversion = _startConversion;
+}
+
+void PotScanner::begin() {
+    currentChannel = 0;
+    conversionPending = false;
+    selectChannel(currentChannel);
+}
+
+// called from the scan timer
+void PotScanner::trigger() {
+    if (conversionPending) {
+        missedTriggers++;
+        return;
+    }
+    conversionPending = true;
+    startConversion();
+}
+
+// called from the ADC completion interrupt
+void PotScanner::onConversionComplete(const uint16_t value) {
+    samples[currentChannel] = value;
+    conversionPending = false;
+    currentChannel = (currentChannel + 1) % CHANNELS;
+    if (currentChannel == 0) {
+        sweepCount++;
+    }
+    // switch now so the mux settles while we wait for the next trigger
+    selectChannel(currentChannel);
+}
+
+uint16_t PotScanner::getSample(const uint8_t channel) const {
+    return samples[channel];
+}
+
+uint8_t PotScanner::getCurrentChannel() const {
+    return currentChannel;
+}
+
+uint32_t PotScanner::getSweepCount() const {
+    return sweepCount;
+}
+
+uint32_t PotScanner::getMissedTriggers() const {
+    return missedTriggers;
+}
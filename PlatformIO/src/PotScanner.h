@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Globals.h"
+
+/**
+ * @brief Background acquisition of all fader pots through the pot mux
+ *
+ * A timer calls trigger() to start a conversion on the channel the mux already points at, and the ADC
+ * completion interrupt hands the result to onConversionComplete(), which stores it and steps the mux to the
+ * next channel. The mux then has the rest of the sample period to settle, so nothing ever waits on it and the
+ * rest of the firmware just reads the latest sample from memory.
+ *
+ * Register access is passed in as plain functions, so the scan sequencing can be driven by a host-side model.
+ */
+class PotScanner {
+public:
+    /// 8 kHz conversions, every pot is sampled at 1 kHz
+    static constexpr uint32_t SAMPLE_PERIOD_MICROS = 125;
+
+    using SelectChannelFunction = void (*)(uint8_t channel);
+    using StartConversionFunction = void (*)();
+
+    PotScanner(SelectChannelFunction _selectChannel, StartConversionFunction _startConversion);
+
+    void begin();
+
+    void trigger();
+
+    void onConversionComplete(uint16_t value);
+
+    [[nodiscard]] uint16_t getSample(uint8_t channel) const;
+
+    [[nodiscard]] uint8_t getCurrentChannel() const;
+
+    /// Number of full sweeps over all channels
+    [[nodiscard]] uint32_t getSweepCount() const;
+
+    /// Triggers that arrived while the previous conversion had not completed
+    [[nodiscard]] uint32_t getMissedTriggers() const;
+
+private:
+    SelectChannelFunction selectChannel;
+    StartConversionFunction startConversion;
+    volatile uint16_t samples[CHANNELS]{};
+    volatile uint8_t currentChannel = 0;
+    volatile bool conversionPending = false;
+    volatile uint32_t sweepCount = 0;
+    volatile uint32_t missedTriggers = 0;
+};
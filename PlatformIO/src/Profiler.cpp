@@ -0,0 +1,85 @@
+#include "Profiler.h"
+#include <Arduino.h>
+#include "Crc32.h"
+
+
+Profiler::Profiler() {
+    reset();
+}
+
+void Profiler::begin() {
+    // the Teensy startup code already runs the cycle counter, this only makes sure
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+}
+
+void Profiler::record(const Scope scope, const uint32_t cycles) {
+    const uint8_t bucket = cycles == 0 ? 0 : 31 - __builtin_clz(cycles);
+    __disable_irq();
+    ScopeStats &stats = scopes[scope];
+    stats.count++;
+    stats.minCycles = min(stats.minCycles, cycles);
+    stats.maxCycles = max(stats.maxCycles, cycles);
+    stats.totalCycles += cycles;
+    stats.histogram[bucket]++;
+    __enable_irq();
+}
+
+Profiler::ScopeStats Profiler::getStats(const Scope scope) const {
+    __disable_irq();
+    ScopeStats stats = scopes[scope];
+    __enable_irq();
+    return stats;
+}
+
+const char *Profiler::getName(const Scope scope) {
+    return NAMES[scope];
+}
+
+void Profiler::reset() {
+    __disable_irq();
+    for (auto &stats: scopes) {
+        stats = {};
+        stats.minCycles = UINT32_MAX;
+    }
+    __enable_irq();
+}
+
+void Profiler::dump(Print &out) const {
+    uint32_t crc = 0xFFFFFFFF;
+    constexpr uint32_t cpuHz = F_CPU;
+    constexpr uint8_t header[] = {VERSION, SCOPE_COUNT, BUCKETS, 0};
+    write(out, crc, &MAGIC, sizeof(MAGIC));
+    write(out, crc, header, sizeof(header));
+    write(out, crc, &cpuHz, sizeof(cpuHz));
+    for (uint8_t scope = 0; scope < SCOPE_COUNT; scope++) {
+        // copy first so an interrupt cannot change the numbers half way through
+        const ScopeStats stats = getStats(static_cast<Scope>(scope));
+        const auto nameLength = static_cast<uint8_t>(strlen(NAMES[scope]));
+        write(out, crc, &nameLength, sizeof(nameLength));
+        write(out, crc, NAMES[scope], nameLength);
+        write(out, crc, &stats.count, sizeof(stats.count));
+        write(out, crc, &stats.minCycles, sizeof(stats.minCycles));
+        write(out, crc, &stats.maxCycles, sizeof(stats.maxCycles));
+        write(out, crc, &stats.totalCycles, sizeof(stats.totalCycles));
+        uint32_t mask = 0;
+        for (uint8_t bucket = 0; bucket < BUCKETS; bucket++) {
+            if (stats.histogram[bucket] != 0) {
+                mask |= 1UL << bucket;
+            }
+        }
+        write(out, crc, &mask, sizeof(mask));
+        for (uint8_t bucket = 0; bucket < BUCKETS; bucket++) {
+            if (stats.histogram[bucket] != 0) {
+                write(out, crc, &stats.histogram[bucket], sizeof(stats.histogram[bucket]));
+            }
+        }
+    }
+    crc = ~crc;
+    out.write(reinterpret_cast<const uint8_t *>(&crc), sizeof(crc));
+}
+
+void Profiler::write(Print &out, uint32_t &crc, const void *data, const size_t length) {
+    out.write(static_cast<const uint8_t *>(data), length);
+    crc = crc32Update(crc, data, length);
+}
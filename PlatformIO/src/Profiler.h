@@ -0,0 +1,95 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Cycle counting profiler for the hot paths, built on the Cortex-M7 DWT cycle counter
+ *
+ * Every scope keeps count, min, max and total cycles plus a histogram with one bucket per power of two
+ * (bucket n holds durations of 2^n to 2^(n+1)-1 cycles), so rare slow runs stay visible next to the average.
+ * Recording takes a few dozen cycles and is safe from interrupts.
+ *
+ * dump() writes everything in binary (little endian):
+ * [MAGIC 4B][VERSION 1B][SCOPES 1B][BUCKETS 1B][RESERVED 1B][CPU_HZ 4B]
+ * then per scope: [NAME_LENGTH 1B][NAME][COUNT 4B][MIN 4B][MAX 4B][TOTAL 8B][BUCKET_MASK 4B][COUNT 4B per set bit]
+ * and finally [CRC32 4B] over everything before it. tools/profile_decode.py turns it back into a table.
+ */
+class Profiler {
+public:
+    enum Scope : uint8_t {
+        MUX_SWITCH,
+        ADC_READ,
+        TOUCH_READ,
+        MOTOR_UPDATE,
+        DRAW_ICON,
+        UPDATE_SCREEN,
+        PACKET_DISPATCH,
+        DECOMPRESS,
+        SCOPE_COUNT
+    };
+
+    static constexpr uint8_t BUCKETS = 32;
+
+    struct ScopeStats {
+        uint32_t count;
+        uint32_t minCycles;
+        uint32_t maxCycles;
+        uint64_t totalCycles;
+        uint32_t histogram[BUCKETS];
+    };
+
+    Profiler();
+
+    ~Profiler() = default;
+
+    void begin();
+
+    void record(Scope scope, uint32_t cycles);
+
+    [[nodiscard]] ScopeStats getStats(Scope scope) const;
+
+    [[nodiscard]] static const char *getName(Scope scope);
+
+    void reset();
+
+    void dump(Print &out) const;
+
+private:
+    static constexpr uint32_t MAGIC = 0x52504246; // "FBPR"
+    static constexpr uint8_t VERSION = 1;
+    static constexpr const char *NAMES[SCOPE_COUNT] = {
+        "mux switch",
+        "adc read",
+        "touch read",
+        "motor update",
+        "drawIcon",
+        "updateScreen",
+        "packet dispatch",
+        "fastlz_decompress",
+    };
+
+    ScopeStats scopes[SCOPE_COUNT]{};
+
+    static void write(Print &out, uint32_t &crc, const void *data, size_t length);
+};
+
+inline Profiler profiler;
+
+/// Records the lifetime of the object as one run of the scope
+class ProfileScope {
+public:
+    explicit ProfileScope(const Profiler::Scope _scope) : scope(_scope), start(ARM_DWT_CYCCNT) {
+    }
+
+    ~ProfileScope() {
+        profiler.record(scope, ARM_DWT_CYCCNT - start);
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    Profiler::Scope scope;
+    uint32_t start;
+};
@@ -0,0 +1,40 @@
+#include "TFTPanel.h"
+#include <Arduino.h>
+
+
+TFTPanel::TFTPanel(const int8_t _cs, const uint8_t _dc, const uint8_t _rst) : ST7789_t3(_cs, _dc, _rst) {
+}
+
+void TFTPanel::updateRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (!_use_fbtft || _pfbtft == nullptr) {
+        return;
+    }
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        h += y;
+        y = 0;
+    }
+    w = min(w, static_cast<int16_t>(width() - x));
+    h = min(h, static_cast<int16_t>(height() - y));
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+
+    beginSPITransaction();
+    setAddr(x, y, x + w - 1, y + h - 1);
+    writecommand_cont(ST7735_RAMWR);
+    const uint16_t *last = &_pfbtft[(y + h - 1) * width() + x + w - 1];
+    for (int16_t row = y; row < y + h; row++) {
+        for (const uint16_t *pixel = &_pfbtft[row * width() + x], *end = pixel + w; pixel < end; pixel++) {
+            if (pixel == last) {
+                writedata16_last(*pixel);
+            } else {
+                writedata16_cont(*pixel);
+            }
+        }
+    }
+    endSPITransaction();
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ST7789_t3.h>
+
+/**
+ * @brief ST7789 driver that can push part of the frame buffer instead of the whole screen
+ *
+ * updateRect() sets the panel's column/row window (CASET/RASET) to the rectangle and streams just those
+ * pixels out of the frame buffer, so a changed text line costs a few KB on the bus instead of the full
+ * 240x240 frame. Everything else is plain ST7789_t3.
+ */
+class TFTPanel : public ST7789_t3 {
+public:
+    TFTPanel(int8_t _cs, uint8_t _dc, uint8_t _rst);
+
+    /// Sends one rectangle of the frame buffer to the panel, clipped to the screen
+    void updateRect(int16_t x, int16_t y, int16_t w, int16_t h);
+};
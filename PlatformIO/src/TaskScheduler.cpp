@@ -0,0 +1,75 @@
+#include "TaskScheduler.h"
+#include <Arduino.h>
+
+
+uint8_t TaskScheduler::addTask(const char *name, const TaskFunction function, const uint32_t periodMicros,
+                               const uint32_t budgetMicros) {
+    if (taskCount >= MAX_TASKS) {
+        return INVALID_TASK;
+    }
+    Task &task = tasks[taskCount];
+    task.name = name;
+    task.function = function;
+    task.periodMicros = periodMicros;
+    task.budgetMicros = budgetMicros;
+    // due on the first pass
+    task.lastRun = micros() - periodMicros;
+    return taskCount++;
+}
+
+void TaskScheduler::run() {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        Task &task = tasks[i];
+        const uint32_t now = micros();
+        const uint32_t sinceLast = now - task.lastRun;
+        if (sinceLast < task.periodMicros) {
+            continue;
+        }
+        task.stats.maxLatenessMicros = max(task.stats.maxLatenessMicros, sinceLast - task.periodMicros);
+        // no catching up: a late task runs once and starts a fresh period
+        task.lastRun = now;
+        task.function(task.budgetMicros);
+        const uint32_t elapsed = micros() - now;
+        task.stats.runs++;
+        task.stats.lastMicros = elapsed;
+        task.stats.maxMicros = max(task.stats.maxMicros, elapsed);
+        task.stats.totalMicros += elapsed;
+        if (elapsed > task.budgetMicros) {
+            task.stats.overBudget++;
+        }
+    }
+}
+
+uint8_t TaskScheduler::getTaskCount() const {
+    return taskCount;
+}
+
+const char *TaskScheduler::getName(const uint8_t task) const {
+    return tasks[task].name;
+}
+
+TaskScheduler::TaskStats TaskScheduler::getStats(const uint8_t task) const {
+    return tasks[task].stats;
+}
+
+uint32_t TaskScheduler::getAverageMicros(const uint8_t task) const {
+    const TaskStats &stats = tasks[task].stats;
+    return stats.runs == 0 ? 0 : static_cast<uint32_t>(stats.totalMicros / stats.runs);
+}
+
+void TaskScheduler::resetStats() {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        tasks[i].stats = {};
+    }
+}
+
+void TaskScheduler::printStats(Print &out) const {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        const TaskStats &stats = tasks[i].stats;
+        // uint32_t is unsigned long on the Teensy but not on every host
+        out.printf("%-10s runs %lu avg %lu us max %lu us budget %lu us over %lu late %lu us\n", tasks[i].name,
+                   static_cast<unsigned long>(stats.runs), static_cast<unsigned long>(getAverageMicros(i)),
+                   static_cast<unsigned long>(stats.maxMicros), static_cast<unsigned long>(tasks[i].budgetMicros),
+                   static_cast<unsigned long>(stats.overBudget), static_cast<unsigned long>(stats.maxLatenessMicros));
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Cooperative round of periodic tasks run from loop()
+ *
+ * Every task has a period and a time budget. run() calls each task that is due, in the order they were added,
+ * and hands it its budget so tasks with divisible work (draining queues, sending screen regions) can stop early
+ * and pick up on the next pass. Nothing is preempted: a task that runs past its budget is only counted, which
+ * shows up in the stats as the thing to split further.
+ *
+ * Timing-critical work (servo control, pot and touch scanning) stays on its hardware timers, the tasks here
+ * only cover what used to run inline in loop().
+ */
+class TaskScheduler {
+public:
+    /// Called with the task's budget in microseconds
+    using TaskFunction = void (*)(uint32_t budgetMicros);
+
+    static constexpr uint8_t MAX_TASKS = 12;
+    static constexpr uint8_t INVALID_TASK = 0xFF;
+
+    struct TaskStats {
+        uint32_t runs;
+        uint32_t overBudget;
+        uint32_t lastMicros;
+        uint32_t maxMicros;
+        uint64_t totalMicros;
+        /// Largest delay between the task becoming due and it actually running
+        uint32_t maxLatenessMicros;
+    };
+
+    TaskScheduler() = default;
+
+    ~TaskScheduler() = default;
+
+    /// A period of 0 runs the task on every pass, returns the task id or INVALID_TASK when full
+    uint8_t addTask(const char *name, TaskFunction function, uint32_t periodMicros, uint32_t budgetMicros);
+
+    void run();
+
+    [[nodiscard]] uint8_t getTaskCount() const;
+
+    [[nodiscard]] const char *getName(uint8_t task) const;
+
+    [[nodiscard]] TaskStats getStats(uint8_t task) const;
+
+    [[nodiscard]] uint32_t getAverageMicros(uint8_t task) const;
+
+    void resetStats();
+
+    void printStats(Print &out) const;
+
+private:
+    struct Task {
+        const char *name = nullptr;
+        TaskFunction function = nullptr;
+        uint32_t periodMicros = 0;
+        uint32_t budgetMicros = 0;
+        uint32_t lastRun = 0;
+        TaskStats stats{};
+    };
+
+    Task tasks[MAX_TASKS];
+    uint8_t taskCount = 0;
+};
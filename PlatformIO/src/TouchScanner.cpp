@@ -0,0 +1,163 @@
+#include "TouchScanner.h"
+#include <Arduino.h>
+
+
+TouchScanner::TouchScanner(const Hardware &_hardware, const uint32_t _cyclesPerMicro) {
+    hardware = _hardware;
+    cyclesPerMicro = _cyclesPerMicro;
+}
+
+void TouchScanner::begin() {
+    currentChannel = CHANNELS - 1;
+    nextChannel(hardware.readCycles());
+}
+
+// called from the touch timer, moves the state machine along whenever a wait has run out
+void TouchScanner::poll() {
+    const uint32_t now = hardware.readCycles();
+    switch (phase) {
+        case Phase::IDLE:
+            nextChannel(now);
+            break;
+        case Phase::SETTLING:
+            if (elapsed(now, MUX_SETTLE_MICROS)) {
+                beginCharge();
+            }
+            break;
+        case Phase::RESTING:
+            if (elapsed(now, REST_MICROS)) {
+                beginCharge();
+            }
+            break;
+        case Phase::CHARGING:
+        case Phase::DISCHARGING:
+            if (elapsed(now, TIMEOUT_MICROS)) {
+                timeoutCount++;
+                finishSample(now, false, 0);
+            }
+            break;
+    }
+}
+
+// called from the receive pin change interrupt
+void TouchScanner::onEdge() {
+    const uint32_t now = hardware.readCycles();
+    // the pin level filters out edges caused by our own precharge and discharge writes
+    if (phase == Phase::CHARGING && hardware.readReceive()) {
+        chargeCycles = now - phaseStart;
+        phase = Phase::IDLE;
+        hardware.startDischarge();
+        phaseStart = hardware.readCycles();
+        phase = Phase::DISCHARGING;
+    } else if (phase == Phase::DISCHARGING && !hardware.readReceive()) {
+        finishSample(now, true, now - phaseStart);
+    }
+}
+
+void TouchScanner::setEnabled(const uint8_t channel, const bool enabled) {
+    channels[channel].enabled = enabled;
+    if (!enabled) {
+        channels[channel].touched = false;
+        channels[channel].agreeingReadings = 0;
+    }
+}
+
+void TouchScanner::setSensitivity(const uint8_t channel, const float sensitivity) {
+    channels[channel].sensitivity = sensitivity;
+}
+
+float TouchScanner::getSensitivity(const uint8_t channel) const {
+    return channels[channel].sensitivity;
+}
+
+void TouchScanner::setBaseline(const uint8_t channel, const uint32_t baseline) {
+    channels[channel].baseline = baseline;
+}
+
+uint32_t TouchScanner::getBaseline(const uint8_t channel) const {
+    return channels[channel].baseline;
+}
+
+// the fader must not be touched while this is called
+void TouchScanner::captureBaseline(const uint8_t channel) {
+    channels[channel].baseline = channels[channel].reading;
+}
+
+uint32_t TouchScanner::getReading(const uint8_t channel) const {
+    return channels[channel].reading;
+}
+
+bool TouchScanner::isTouched(const uint8_t channel) const {
+    return channels[channel].touched;
+}
+
+uint32_t TouchScanner::getSweepCount() const {
+    return sweepCount;
+}
+
+uint32_t TouchScanner::getTimeoutCount() const {
+    return timeoutCount;
+}
+
+bool TouchScanner::elapsed(const uint32_t now, const uint32_t micros) const {
+    return now - phaseStart >= micros * cyclesPerMicro;
+}
+
+void TouchScanner::beginCharge() {
+    phase = Phase::IDLE;
+    hardware.startCharge();
+    phaseStart = hardware.readCycles();
+    phase = Phase::CHARGING;
+}
+
+void TouchScanner::finishSample(const uint32_t now, const bool valid, const uint32_t cycles) {
+    phase = Phase::IDLE;
+    if (valid) {
+        sampleSum += chargeCycles + cycles;
+        samplesCounted++;
+    }
+    samplesTaken++;
+    if (samplesTaken >= SAMPLES_PER_CHANNEL) {
+        publish();
+        nextChannel(now);
+        return;
+    }
+    hardware.rest();
+    phaseStart = now;
+    phase = Phase::RESTING;
+}
+
+void TouchScanner::publish() {
+    ChannelState &state = channels[currentChannel];
+    if (samplesCounted == 0) {
+        return;
+    }
+    state.reading = sampleSum / samplesCounted;
+    const bool touchedNow = static_cast<float>(state.reading) > static_cast<float>(state.baseline) * state.sensitivity;
+    if (touchedNow == state.touched) {
+        state.agreeingReadings = 0;
+    } else if (++state.agreeingReadings >= DEBOUNCE_READINGS) {
+        state.touched = touchedNow;
+        state.agreeingReadings = 0;
+    }
+}
+
+void TouchScanner::nextChannel(const uint32_t now) {
+    phase = Phase::IDLE;
+    hardware.rest();
+    sampleSum = 0;
+    samplesTaken = 0;
+    samplesCounted = 0;
+    for (uint8_t step = 0; step < CHANNELS; step++) {
+        currentChannel = (currentChannel + 1) % CHANNELS;
+        if (currentChannel == 0) {
+            sweepCount++;
+        }
+        if (channels[currentChannel].enabled) {
+            hardware.selectChannel(currentChannel);
+            phaseStart = now;
+            phase = Phase::SETTLING;
+            return;
+        }
+    }
+}
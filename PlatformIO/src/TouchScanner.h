@@ -0,0 +1,110 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Globals.h"
+
+/**
+ * @brief Non-blocking capacitive touch acquisition for all faders
+ *
+ * Same measurement as CapacitiveSensor (charge time plus discharge time of the receive pin through the send
+ * resistor), but the edges are timed with a pin change interrupt and the cycle counter instead of a busy loop.
+ * poll() runs from a timer, steps the touch mux, lets it settle and starts each charge; onEdge() runs from the
+ * receive pin interrupt and timestamps the edges. Nothing in loop() waits on a measurement any more, loop()
+ * just reads the published, debounced touch state.
+ *
+ * All pin access and the clock go through the Hardware functions, so the sequencing can run against a model.
+ * poll() and onEdge() must run at the same interrupt priority so they never preempt each other.
+ */
+class TouchScanner {
+public:
+    struct Hardware {
+        void (*selectChannel)(uint8_t channel);
+        /// Receive pin to input, then raise the send pin
+        void (*startCharge)();
+        /// Precharge the receive pin high, back to input, then lower the send pin
+        void (*startDischarge)();
+        /// Hold the receive pin low so the electrode is empty before the next charge
+        void (*rest)();
+        bool (*readReceive)();
+        uint32_t (*readCycles)();
+    };
+
+    static constexpr uint32_t POLL_PERIOD_MICROS = 50;
+    static constexpr uint8_t SAMPLES_PER_CHANNEL = 8;
+    static constexpr uint32_t MUX_SETTLE_MICROS = 50;
+    static constexpr uint32_t REST_MICROS = 10;
+    static constexpr uint32_t TIMEOUT_MICROS = 1000;
+    /// Consecutive agreeing readings needed to change the touch state
+    static constexpr uint8_t DEBOUNCE_READINGS = 2;
+
+    TouchScanner(const Hardware &_hardware, uint32_t _cyclesPerMicro);
+
+    void begin();
+
+    void poll();
+
+    void onEdge();
+
+    void setEnabled(uint8_t channel, bool enabled);
+
+    void setSensitivity(uint8_t channel, float sensitivity);
+
+    [[nodiscard]] float getSensitivity(uint8_t channel) const;
+
+    void setBaseline(uint8_t channel, uint32_t baseline);
+
+    [[nodiscard]] uint32_t getBaseline(uint8_t channel) const;
+
+    void captureBaseline(uint8_t channel);
+
+    /// Averaged charge plus discharge time of the last completed reading, in CPU cycles
+    [[nodiscard]] uint32_t getReading(uint8_t channel) const;
+
+    [[nodiscard]] bool isTouched(uint8_t channel) const;
+
+    /// Number of full passes over all enabled channels
+    [[nodiscard]] uint32_t getSweepCount() const;
+
+    [[nodiscard]] uint32_t getTimeoutCount() const;
+
+private:
+    enum class Phase : uint8_t {
+        IDLE,
+        SETTLING,
+        RESTING,
+        CHARGING,
+        DISCHARGING,
+    };
+
+    struct ChannelState {
+        volatile bool enabled = false;
+        volatile bool touched = false;
+        volatile uint32_t reading = 0;
+        volatile uint32_t baseline = 0;
+        float sensitivity = 1.5f;
+        uint8_t agreeingReadings = 0;
+    };
+
+    Hardware hardware;
+    uint32_t cyclesPerMicro;
+    ChannelState channels[CHANNELS];
+    volatile Phase phase = Phase::IDLE;
+    uint8_t currentChannel = 0;
+    uint32_t phaseStart = 0;
+    uint32_t chargeCycles = 0;
+    uint32_t sampleSum = 0;
+    uint8_t samplesTaken = 0;
+    uint8_t samplesCounted = 0;
+    volatile uint32_t sweepCount = 0;
+    volatile uint32_t timeoutCount = 0;
+
+    [[nodiscard]] bool elapsed(uint32_t now, uint32_t micros) const;
+
+    void beginCharge();
+
+    void finishSample(uint32_t now, bool valid, uint32_t cycles);
+
+    void publish();
+
+    void nextChannel(uint32_t now);
+};
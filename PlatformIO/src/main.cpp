@@ -1,6 +1,5 @@
 #include <Arduino.h>
 #include <Adafruit_GFX.h>
-#include "thirdparty/fastlz.h"
 #include "icons.h"
 #include "packets/RecNewPID.h"
 #include "packets/RecChannelData.h"
@@ -11,8 +10,25 @@
 #include "packets/RecPIDClosed.h"
 #include "packets/PacketSender.h"
 #include "packets/RecIconPacket.h"
+#include "packets/RecMultiMessage.h"
 #include "ByteArrayQueue.h"
 #include "FaderChannel.h"
+#include "FaderServo.h"
+#include "PotScanner.h"
+#include "TouchScanner.h"
+#include "CalibrationStore.h"
+#include "Calibrator.h"
+#include "MuxManager.h"
+#include "DisplayScheduler.h"
+#include "FrameBufferPool.h"
+#include "MemoryArena.h"
+#include "IconStore.h"
+#include "IconCache.h"
+#include "IconTransfers.h"
+#include "IconRLE.h"
+#include "DecodeBenchmark.h"
+#include "TaskScheduler.h"
+#include "Profiler.h"
 
 // Functions
 /**************************************************/
@@ -30,8 +46,18 @@ void iconPacket(const uint8_t buf[PACKET_SIZE]);
 
 void update(uint8_t *buf);
 
+void dispatch(uint8_t *buf);
+
+void multiMessage(const uint8_t buf[PACKET_SIZE]);
+
 void requestIcon(uint32_t pid);
 
+void applyIcon(uint32_t pid, IconHandle icon);
+
+IconHandle newIcon();
+
+const char *processName(uint32_t pid);
+
 void iconIsDefault(const uint8_t buf[PACKET_SIZE]) ;
 
 void requestAllProcesses();
@@ -50,6 +76,68 @@ void newPID(const uint8_t buf[PACKET_SIZE]);
 
 void updateProcess(uint32_t channel);
 
+uint16_t readPotSample(uint8_t channel);
+
+void servoTick();
+
+void potScanTick();
+
+void startPotConversion();
+
+void potConversionComplete();
+
+void touchPollTick();
+
+void touchStartCharge();
+
+void touchStartDischarge();
+
+void touchRest();
+
+bool touchReadReceive();
+
+uint32_t readCycleCounter();
+
+void touchEdge();
+
+void waitForTouchSweep();
+
+bool restoreCalibration();
+
+void runCalibration();
+
+void finishCalibration();
+
+void saveCalibration();
+
+void printBootTiming();
+
+void printMemoryReport();
+
+void printStatsReport();
+
+void finishReceivedIcon(uint32_t pid, IconHandle icon, bool decoded);
+
+void sendIconAck(uint8_t ackPacket, uint8_t transfer, uint16_t received, uint8_t freeTransfers);
+
+void inputTask(uint32_t budgetMicros);
+
+void fadersTask(uint32_t budgetMicros);
+
+void usbTask(uint32_t budgetMicros);
+
+void displayTask(uint32_t budgetMicros);
+
+void ledTask(uint32_t budgetMicros);
+
+void consoleTask(uint32_t budgetMicros);
+
+void runDecodeBenchmark();
+
+void beginMemoryArenas();
+
+MemoryArena *scratchArena();
+
 
 // Transitory Variables for passing data around
 PacketSender packetSender;
@@ -58,28 +146,100 @@ PacketSender packetSender;
 // flags
 int faderRequest = -1;
 
+// Boot phase timestamps (millis since reset)
+struct BootTiming {
+    uint32_t setupStart = 0;
+    uint32_t usbConfigured = 0;
+    uint32_t calibrationStart = 0;
+    uint32_t calibrationEnd = 0;
+    uint32_t initEnd = 0;
+    bool calibrationRestored = false;
+} bootTiming;
+
 /**************************************************/
 
+// Fader servo and pot scan, both run from their own timers so motor response does not depend on loop() time
+PotScanner potScanner(selectPotMux, startPotConversion);
+FaderServo faderServo(readPotSample);
+IntervalTimer potScanTimer;
+IntervalTimer servoTimer;
+
+// Touch scan, the timer and the receive pin interrupt share the default priority so they never preempt each other
+TouchScanner touchScanner({
+                              selectTouchMux, touchStartCharge, touchStartDischarge, touchRest, touchReadReceive,
+                              readCycleCounter
+                          }, F_CPU / 1000000);
+IntervalTimer touchTimer;
+
+CalibrationStore calibrationStore;
+// raw counts a resting fader may sit outside its stored range before the calibration is considered stale
+static constexpr uint16_t POSITION_DRIFT_LIMIT = 25;
+// relative change of an untouched reading before the stored touch baseline is considered stale
+static constexpr float TOUCH_DRIFT_LIMIT = 0.3f;
+
+// Large buffers come out of two arenas set up at boot instead of static arrays or scattered malloc() calls.
+// PSRAM holds the retained frames and the icon slots. RAM2 (the heap, behind DMAMEM) holds scratch buffers, or
+// the shared frame and the fallback icon slots on a board without PSRAM.
+static constexpr size_t PSRAM_ARENA_BYTES = 3 * 1024 * 1024;
+static constexpr size_t RAM2_SCRATCH_BYTES = 160 * 1024;
+static constexpr size_t RAM2_FALLBACK_BYTES =
+        FrameBufferPool::FRAME_BYTES + IconStore::FALLBACK_PIXEL_SLOTS * IconStore::ICON_BYTES + 1024;
+MemoryArena psramArena("PSRAM");
+MemoryArena ram2Arena("RAM2");
+
+// icon pixels shared by the channels and the icon cache, channels only keep handles
+IconStore iconStore(&psramArena, &ram2Arena);
 
 FaderChannel faderChannels[CHANNELS] = {
     // 8 fader channels
-    FaderChannel(0, &LEDs, &analog, &capSensor, &tft, 1, 2, true),
-    FaderChannel(1, &LEDs, &analog, &capSensor, &tft, 3, 4, false),
-    FaderChannel(2, &LEDs, &analog, &capSensor, &tft, 5, 6, false),
-    FaderChannel(3, &LEDs, &analog, &capSensor, &tft, 7, 8, false),
-    FaderChannel(4, &LEDs, &analog, &capSensor, &tft, 24, 25, false),
-    FaderChannel(5, &LEDs, &analog, &capSensor, &tft, 28, 29, false),
-    FaderChannel(6, &LEDs, &analog, &capSensor, &tft, 14, 15, false),
-    FaderChannel(7, &LEDs, &analog, &capSensor, &tft, 22, 23, false)
+    FaderChannel(0, &LEDs, &analog, &touchScanner, &tft, &faderServo, &iconStore, 1, 2, true),
+    FaderChannel(1, &LEDs, &analog, &touchScanner, &tft, &faderServo, &iconStore, 3, 4, false),
+    FaderChannel(2, &LEDs, &analog, &touchScanner, &tft, &faderServo, &iconStore, 5, 6, false),
+    FaderChannel(3, &LEDs, &analog, &touchScanner, &tft, &faderServo, &iconStore, 7, 8, false),
+    FaderChannel(4, &LEDs, &analog, &touchScanner, &tft, &faderServo, &iconStore, 24, 25, false),
+    FaderChannel(5, &LEDs, &analog, &touchScanner, &tft, &faderServo, &iconStore, 28, 29, false),
+    FaderChannel(6, &LEDs, &analog, &touchScanner, &tft, &faderServo, &iconStore, 14, 15, false),
+    FaderChannel(7, &LEDs, &analog, &touchScanner, &tft, &faderServo, &iconStore, 22, 23, false)
 };
 
+Calibrator calibrator(faderChannels, &faderServo);
+// everything loop() does, with rates and budgets in microseconds
+TaskScheduler taskScheduler;
+static constexpr uint32_t INPUT_PERIOD_MICROS = 1000;
+static constexpr uint32_t FADERS_PERIOD_MICROS = 1000;
+static constexpr uint32_t LED_PERIOD_MICROS = 20000;
+static constexpr uint32_t CONSOLE_PERIOD_MICROS = 100000;
+
+// owns the CS mux, screens are only drawn and sent from here so loop() never waits on a full frame
+FrameBufferPool frameBufferPool(&psramArena, &ram2Arena);
+DisplayScheduler displayScheduler(&tft, faderChannels, &frameBufferPool);
+// icons seen before are shown again without asking the computer
+IconCache iconCache(&iconStore);
+// icon packets are decompressed as they arrive, straight into the slot the icon ends up in, several icons at once
+IconTransfers iconTransfers(&iconStore, newIcon, finishReceivedIcon, sendIconAck);
+
 void setup() {
+    bootTiming.setupStart = millis();
+    profiler.begin();
+    muxManager.begin();
     pinMode(POT_INPUT, INPUT);
     Serial.begin(9600);
     LEDs.begin();
     pinMode(CS_LOCK, OUTPUT);
     digitalWrite(CS_LOCK, LOW);
     tft.init(SCREEN_WIDTH, SCREEN_HEIGHT, SPI_MODE2);
+    beginMemoryArenas();
+    if (frameBufferPool.begin()) {
+        tft.setFrameBuffer(frameBufferPool.get(MASTER_CHANNEL)); // otherwise useFrameBuffer() allocates its own
+    } else {
+        Serial.println("No memory for the frame buffer pool");
+    }
+    if (!iconStore.begin()) {
+        Serial.println("No memory for the icon store");
+    }
+    // every fader channel keeps its icon slot while the others receive, only 2 are left over without PSRAM
+    const uint8_t channelIcons = CHANNELS - FIRST_CHANNEL;
+    iconTransfers.begin(iconStore.getPixelSlots() > channelIcons ? iconStore.getPixelSlots() - channelIcons : 1);
     tft.useFrameBuffer(true);
     tft.fillScreen(ST77XX_BLACK);
     tft.setTextColor(ST77XX_WHITE);
@@ -122,41 +282,49 @@ void setup() {
     //    usb_rawhid_recv(buf, 0);
     //}
     Serial.println("USB configured");
+    bootTiming.usbConfigured = millis();
     digitalWrite(CS_LOCK, HIGH); // unlock the screens
     LEDs.clear();
     LEDs.show();
-    capSensor.set_CS_AutocaL_Millis(0xFFFFFFFF); // set up the capacitive sensor
-    capSensor.set_CS_Timeout_Millis(100);
-    capSensor.reset_CS_AutoCal();
-    capSensor.capacitiveSensor(30);
+    pinMode(TOUCH_SEND, OUTPUT); // set up the capacitive touch scan
+    digitalWriteFast(TOUCH_SEND, LOW);
+    attachInterrupt(digitalPinToInterrupt(TOUCH_RECEIVE), touchEdge, CHANGE);
+    touchScanner.begin();
+    touchTimer.begin(touchPollTick, TouchScanner::POLL_PERIOD_MICROS);
+    analogRead(POT_INPUT); // let the core configure and calibrate ADC1 before the scanner takes it over
+    attachInterruptVector(IRQ_ADC1, potConversionComplete);
+    NVIC_ENABLE_IRQ(IRQ_ADC1);
+    potScanner.begin();
+    potScanTimer.begin(potScanTick, PotScanner::SAMPLE_PERIOD_MICROS);
+    servoTimer.begin(servoTick, FaderServo::TICK_PERIOD_MICROS);
     init();
-}
 
+    taskScheduler.addTask("input", inputTask, INPUT_PERIOD_MICROS, 800);
+    taskScheduler.addTask("faders", fadersTask, FADERS_PERIOD_MICROS, 300);
+    taskScheduler.addTask("usb", usbTask, 0, 500);
+    taskScheduler.addTask("display", displayTask, 0, 2500);
+    taskScheduler.addTask("leds", ledTask, LED_PERIOD_MICROS, 100);
+    taskScheduler.addTask("console", consoleTask, CONSOLE_PERIOD_MICROS, 200);
+}
 
-uint8_t buf[PACKET_SIZE];
 
 void loop() {
-    reButtonMux.update(); // update the encoders and buttons
+    taskScheduler.run();
+    // everything the tasks sent in this pass leaves in as few reports as it fits in
+    packetSender.flush();
+    muxManager.endLoop();
+}
+
+// buttons and encoders on the three MCP23017 expanders
+void inputTask(uint32_t) {
+    reButtonMux.update();
     leButtonMux.update();
     rotaryMux.update();
-    for (int i = 0; i < CHANNELS; i++) // update the fade channels
-    {
-    const auto start = millis();
+    for (int i = 0; i < CHANNELS; i++) {
         encoder[i].update(rotaryMux.digitalRead(i * 2), rotaryMux.digitalRead(i * 2 + 1), 2, LOW);
         enButton[i].update(reButtonMux.digitalRead(i), 50, LOW);
         leButton[2 * i].update(leButtonMux.digitalRead(i * 2), 50, LOW);
         leButton[2 * i + 1].update(leButtonMux.digitalRead(i * 2 + 1), 50, LOW);
-        if (faderChannels[i].userChanged) {
-            faderChannels[i].userChanged = false;
-            sendChangeOfMaxVolume(i);
-        }
-
-        if (faderChannels[i].requestProcessRefresh) {
-            packetSender.sendRequestAllProcesses();
-            faderRequest = i;
-            faderChannels[i].requestProcessRefresh = false;
-        }
-
         if (encoder[i].read()) {
             faderChannels[i].onRotaryTurn(encoder[i].increased());
         }
@@ -169,66 +337,357 @@ void loop() {
         if (leButton[2 * i + 1].pressed()) {
             faderChannels[i].onButtonPress(0);
         }
+    }
+}
+
+// feeds the servo and touch state into the channels and handles what the channels asked for
+void fadersTask(uint32_t) {
+    for (int i = 0; i < CHANNELS; i++) {
+        if (faderChannels[i].userChanged) {
+            faderChannels[i].userChanged = false;
+            sendChangeOfMaxVolume(i);
+        }
+
+        if (faderChannels[i].requestProcessRefresh) {
+            packetSender.sendRequestAllProcesses();
+            faderRequest = i;
+            faderChannels[i].requestProcessRefresh = false;
+        }
 
         if (faderChannels[i].requestNewProcess) {
             updateProcess(i);
         }
 
         faderChannels[i].update();
-        const auto end = millis();
-        //Serial.println("Update time for channel " + String(i) + ": " + String(end - start));
     }
-    if (!states.isReceivingChannels() && !states.isReceivingIcon() && !sendingQueue.isEmpty()) {
+    if (calibrator.isRunning() && !calibrator.update(millis())) {
+        finishCalibration();
+    }
+}
+
+// drains packets held back while receiving, then reads new ones until the budget is used up
+void usbTask(const uint32_t budgetMicros) {
+    const uint32_t start = micros();
+    if (!states.isReceivingChannels() && iconTransfers.getFreeTransfers() > 0 && !sendingQueue.isEmpty()) {
         uint8_t buf[PACKET_SIZE];
         if (sendingQueue.pop(buf)) {
             update(buf);
         }
     }
-    if (const uint8_t res = RawHID.recv(buf, 0); res > 0) {
+    while (micros() - start < budgetMicros) {
+        uint8_t buf[PACKET_SIZE];
+        if (RawHID.recv(buf, 0) <= 0) {
+            break;
+        }
         Serial.println("Packet received: " + String(buf[PacketPositions::Base::STATUS_INDEX]));
         update(buf);
-        LEDs.show();
     }
 }
 
-// set fader pot and touch values then get initial data from computer on startup
-void init() {
-    initializing = true;
-    for (const auto &faderChannel: faderChannels) {
-        faderChannel.motor->forward(65);
+void displayTask(uint32_t) {
+    displayScheduler.update();
+}
+
+void ledTask(uint32_t) {
+    LEDs.show();
+}
+
+// the counters of the tasks, display, icon cache, icon transfers and muxes; task and display ones start over
+void printStatsReport() {
+    taskScheduler.printStats(Serial);
+    displayScheduler.printStats(Serial);
+    iconCache.printStats(Serial);
+    iconTransfers.printStats(Serial);
+    muxManager.printStats(Serial);
+    taskScheduler.resetStats();
+    displayScheduler.resetStats();
+}
+
+// single letter commands on the serial port: 'p' dumps the profiler (binary, see Profiler.h), 'r' resets it,
+// 'd' prints FastLZ decode cycles, 'm' the memory report, 's' the stats report, 'c' recalibrates the faders
+void consoleTask(uint32_t) {
+    while (Serial.available() > 0) {
+        switch (Serial.read()) {
+            case 'p':
+                profiler.dump(Serial);
+                Serial.flush();
+                break;
+            case 'r':
+                profiler.reset();
+                break;
+            case 'd':
+                runDecodeBenchmark();
+                break;
+            case 'm':
+                printMemoryReport();
+                break;
+            case 's':
+                printStatsReport();
+                break;
+            case 'c':
+                // drives every motor into both end stops, so it is never one button press away
+                if (!calibrator.isRunning()) {
+                    calibrator.start(millis());
+                }
+                break;
+            default:
+                break;
+        }
     }
-    delay(500);
-    for (auto &faderChannel: faderChannels) {
-        faderChannel.motor->stop();
-        faderChannel.setPositionMax();
-        faderChannel.motor->backward(65);
+}
+
+// FastLZ decode cost of the built-in icon and of every icon the board currently holds, blocks for a moment
+void runDecodeBenchmark() {
+    constexpr uint8_t RUNS = 10;
+    MemoryArena *scratch = scratchArena();
+    auto *builtinPixels = static_cast<uint16_t *>(scratch->allocate(IconStore::ICON_BYTES, "decode benchmark"));
+    DecodeCycles builtin{};
+    if (builtinPixels != nullptr && IconRLE::decompress(defaultIcon.rle, defaultIcon.length, builtinPixels)) {
+        builtin = measureFastLZDecode(builtinPixels, readCycleCounter, RUNS, scratch);
     }
-    delay(500);
-    for (auto &faderChannel: faderChannels) {
-        faderChannel.motor->stop();
-        faderChannel.setPositionMin();
+    printDecodeCycles(Serial, "default icon", builtin);
+    scratch->release(builtinPixels);
+    for (IconHandle icon = 0; icon < IconStore::PIXEL_SLOTS; icon++) {
+        const uint16_t *pixels = iconStore.get(icon);
+        if (pixels != nullptr) {
+            const String name = "icon slot " + String(icon);
+            printDecodeCycles(Serial, name.c_str(), measureFastLZDecode(pixels, readCycleCounter, RUNS, scratch));
+        }
     }
-    for (const auto &faderChannel: faderChannels) {
-        faderChannel.motor->forward(80);
+}
+
+uint16_t readPotSample(const uint8_t channel) {
+    return potScanner.getSample(channel);
+}
+
+void servoTick() {
+    ProfileScope profile(Profiler::MOTOR_UPDATE);
+    faderServo.tick(micros());
+}
+
+void potScanTick() {
+    potScanner.trigger();
+}
+
+// start a single conversion on the pot input with the completion interrupt enabled
+void startPotConversion() {
+    ADC1_HC0 = ADC_HC_AIEN | ADC_HC_ADCH(POT_ADC_CHANNEL);
+}
+
+// reading the result register also clears the conversion complete flag
+void potConversionComplete() {
+    ProfileScope profile(Profiler::ADC_READ);
+    potScanner.onConversionComplete(ADC1_R0);
+}
+
+void touchPollTick() {
+    ProfileScope profile(Profiler::TOUCH_READ);
+    touchScanner.poll();
+}
+
+void touchEdge() {
+    ProfileScope profile(Profiler::TOUCH_READ);
+    touchScanner.onEdge();
+}
+
+void touchStartCharge() {
+    pinMode(TOUCH_RECEIVE, INPUT);
+    digitalWriteFast(TOUCH_SEND, HIGH);
+}
+
+// same precharge sequence CapacitiveSensor uses before timing the discharge
+void touchStartDischarge() {
+    digitalWriteFast(TOUCH_RECEIVE, HIGH);
+    pinMode(TOUCH_RECEIVE, OUTPUT);
+    pinMode(TOUCH_RECEIVE, INPUT);
+    digitalWriteFast(TOUCH_SEND, LOW);
+}
+
+void touchRest() {
+    pinMode(TOUCH_RECEIVE, OUTPUT);
+    digitalWriteFast(TOUCH_RECEIVE, LOW);
+}
+
+bool touchReadReceive() {
+    return digitalReadFast(TOUCH_RECEIVE) == HIGH;
+}
+
+uint32_t readCycleCounter() {
+    return ARM_DWT_CYCCNT;
+}
+
+// block until every enabled channel has a reading taken after this call, only used during init
+void waitForTouchSweep() {
+    const uint32_t sweep = touchScanner.getSweepCount();
+    while (touchScanner.getSweepCount() < sweep + 2) {
+        yield();
     }
-    delay(50);
-    for (const auto &faderChannel: faderChannels) {
-        faderChannel.motor->stop();
+}
+
+// set fader pot and touch values then get initial data from computer on startup
+void init() {
+    initializing = true;
+    bootTiming.calibrationStart = millis();
+    for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+        touchScanner.setEnabled(channel, true);
     }
-    delay(50);
-    capSensor.reset_CS_AutoCal();
-    for (auto &faderChannel: faderChannels) {
-        faderChannel.setUnTouched();
+    // holding the master encoder button during boot forces a fresh calibration
+    const bool forceCalibration = reButtonMux.digitalRead(MASTER_CHANNEL) == LOW;
+    bootTiming.calibrationRestored = !forceCalibration && restoreCalibration();
+    if (!bootTiming.calibrationRestored) {
+        runCalibration();
     }
+    bootTiming.calibrationEnd = millis();
     Serial.println("setting icon to default");
-    faderChannels[MASTER_CHANNEL].setIcon(defaultIcon, ICON_SIZE, ICON_SIZE);
+    const IconHandle icon = iconStore.wrap(defaultIcon);
+    faderChannels[MASTER_CHANNEL].setIcon(icon, ICON_SIZE, ICON_SIZE);
+    iconStore.release(icon);
     for (uint8_t channel = FIRST_CHANNEL; channel < CHANNELS; channel++) {
         faderChannels[channel].setUnused(true);
     }
     Serial.println("finished init");
+    bootTiming.initEnd = millis();
+    printBootTiming();
+    printMemoryReport();
     requestAllProcesses();
 }
 
+// apply the stored calibration, returns false if there is none or the faders no longer agree with it
+bool restoreCalibration() {
+    CalibrationStore::Calibration calibration;
+    if (!calibrationStore.load(calibration)) {
+        Serial.println("No stored calibration");
+        return false;
+    }
+    for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+        faderChannels[channel].applyCalibration(calibration[channel]);
+    }
+    waitForTouchSweep();
+
+    bool touchDrifted = false;
+    for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+        const uint16_t raw = faderServo.getRawPosition(channel);
+        if (raw + POSITION_DRIFT_LIMIT < calibration[channel].positionMin ||
+            raw > calibration[channel].positionMax + POSITION_DRIFT_LIMIT) {
+            Serial.println("Calibration drift on channel " + String(channel) + ", recalibrating");
+            return false;
+        }
+        const float baseline = calibration[channel].touchBaseline;
+        if (fabsf(static_cast<float>(touchScanner.getReading(channel)) - baseline) > baseline * TOUCH_DRIFT_LIMIT) {
+            faderChannels[channel].setUnTouched();
+            touchDrifted = true;
+        }
+    }
+    if (touchDrifted) {
+        Serial.println("Touch baseline drifted, updating stored calibration");
+        saveCalibration();
+    }
+    return true;
+}
+
+// blocking wrapper used during init, at runtime loop() drives the calibrator instead
+void runCalibration() {
+    calibrator.start(millis());
+    while (calibrator.update(millis())) {
+        yield();
+    }
+    finishCalibration();
+}
+
+// baseline the touch sensors with the faders off the end stops and store the result if every channel passed
+void finishCalibration() {
+    waitForTouchSweep();
+    for (auto &faderChannel: faderChannels) {
+        faderChannel.setUnTouched();
+    }
+    for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+        switch (calibrator.getResult(channel)) {
+            case Calibrator::Result::OK:
+                Serial.println("Calibrated channel " + String(channel) + " in " +
+                               String(calibrator.getDuration(channel)) + " ms");
+                break;
+            case Calibrator::Result::NO_TRAVEL:
+                Serial.println("Warning: channel " + String(channel) + " stalled without travelling");
+                break;
+            default:
+                Serial.println("Warning: channel " + String(channel) + " never reached an end stop");
+        }
+    }
+    if (calibrator.succeeded()) {
+        saveCalibration();
+    }
+}
+
+void saveCalibration() {
+    CalibrationStore::Calibration calibration;
+    for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+        calibration[channel] = faderChannels[channel].getCalibration();
+    }
+    calibrationStore.save(calibration);
+}
+
+void printBootTiming() {
+    Serial.println("Boot timing (ms): setup " + String(bootTiming.setupStart) +
+                   ", usb " + String(bootTiming.usbConfigured - bootTiming.setupStart) +
+                   ", calibration " + String(bootTiming.calibrationEnd - bootTiming.calibrationStart) +
+                   (bootTiming.calibrationRestored ? " (restored)" : " (full sweep)") +
+                   ", init " + String(bootTiming.initEnd - bootTiming.calibrationStart) +
+                   ", total " + String(bootTiming.initEnd));
+}
+
+// the arenas' own blocks are the only extmem_malloc() and large malloc() calls the firmware makes
+void beginMemoryArenas() {
+    // extmem_malloc() quietly falls back to the RAM2 heap without PSRAM
+    if (external_psram_size > 0 && !psramArena.begin(extmem_malloc(PSRAM_ARENA_BYTES), PSRAM_ARENA_BYTES)) {
+        Serial.println("No memory for the PSRAM arena");
+    }
+    const size_t ram2Bytes = psramArena.isReady() ? RAM2_SCRATCH_BYTES : RAM2_FALLBACK_BYTES;
+    if (!ram2Arena.begin(malloc(ram2Bytes), ram2Bytes)) {
+        Serial.println("No memory for the RAM2 arena");
+    }
+}
+
+// short lived buffers go to RAM2, faster than PSRAM; without PSRAM the fallback buffers leave no room for them
+MemoryArena *scratchArena() {
+    return &ram2Arena;
+}
+
+// where the big buffers ended up, RAM1 is the fast but small tightly coupled memory
+void printMemoryReport() {
+    struct Entry {
+        const char *name;
+        const void *address;
+        size_t bytes;
+    };
+    const Entry entries[] = {
+        {"frame buffers", frameBufferPool.get(MASTER_CHANNEL), frameBufferPool.getBytesAllocated()},
+        {"fader channels", faderChannels, sizeof(faderChannels)},
+        {"icon store", iconStore.getStorage(), iconStore.getBytesAllocated()},
+        {"LED buffers", LEDDisplayMemory, sizeof(LEDDisplayMemory) + sizeof(LEDDrawingMemory)},
+    };
+    size_t totals[static_cast<uint8_t>(FrameBufferPool::MemoryRegion::UNKNOWN) + 1]{};
+    Serial.println("Memory placement (" + String(frameBufferPool.isRetained() ? "retained" : "shared") +
+                   " frame buffers):");
+    for (const auto &entry: entries) {
+        const auto region = FrameBufferPool::regionOf(entry.address);
+        totals[static_cast<uint8_t>(region)] += entry.bytes;
+        Serial.println("  " + String(entry.name) + ": " + String(entry.bytes) + " B in " +
+                       FrameBufferPool::regionName(region));
+    }
+    for (uint8_t region = 0; region <= static_cast<uint8_t>(FrameBufferPool::MemoryRegion::UNKNOWN); region++) {
+        if (totals[region] > 0) {
+            Serial.println("  total " +
+                           String(FrameBufferPool::regionName(static_cast<FrameBufferPool::MemoryRegion>(region))) +
+                           ": " + String(totals[region]) + " B");
+        }
+    }
+    psramArena.printStats(Serial);
+    ram2Arena.printStats(Serial);
+    Serial.printf("icon slots: %u of %u in use, high water %u\n",
+                  iconStore.getPixelSlots() - iconStore.getFreePixelSlots(), iconStore.getPixelSlots(),
+                  iconStore.getPixelSlotsHighWater());
+}
+
 // send the processes of the 7 fader channels to the computer
 void sendCurrentSelectedProcesses() {
     uint32_t PIDs[CHANNELS - 1];
@@ -247,13 +706,56 @@ void requestAllProcesses() {
     packetSender.sendRequestAllProcesses();
 }
 
-// request the icon of a process from the computer
+// request the icon of a process from the computer, unless it is still in the icon cache
 void requestIcon(const uint32_t pid) {
-    packetSender.sendRequestIcon(pid);
+    const IconHandle cached = iconCache.find(pid, processName(pid));
+    if (cached == NO_ICON) {
+        packetSender.sendRequestIcon(pid);
+        return;
+    }
+    applyIcon(pid, cached);
+}
+
+void applyIcon(const uint32_t pid, const IconHandle icon) {
+    for (uint8_t channel = FIRST_CHANNEL; channel < CHANNELS; channel++) {
+        if (faderChannels[channel].appdata.PID == pid) {
+            faderChannels[channel].setIcon(icon, ICON_SIZE, ICON_SIZE);
+        }
+    }
+}
+
+// a slot for a received icon, cached icons no channel shows are given up when the store is full
+IconHandle newIcon() {
+    IconHandle icon = iconStore.acquire();
+    while (icon == NO_ICON && iconCache.evictOldest()) {
+        icon = iconStore.acquire();
+    }
+    return icon;
+}
+
+// the process list has the name as soon as a channel switches, the channel itself only after CHANNEL_DATA
+const char *processName(const uint32_t pid) {
+    for (size_t i = 0; i < openProcessIDs.getSize(); i++) {
+        if (openProcessIDs[i] == pid) {
+            return openProcessNames[i];
+        }
+    }
+    for (const auto &channel: faderChannels) {
+        if (channel.appdata.PID == pid) {
+            return channel.appdata.name;
+        }
+    }
+    return "";
 }
 
 // main update function
 void update(uint8_t *buf) {
+    ProfileScope profile(Profiler::PACKET_DISPATCH);
+    packetSender.setComputerVersion(buf[PacketPositions::Base::VERSION_INDEX]);
+    dispatch(buf);
+}
+
+void dispatch(uint8_t *buf) {
     switch (buf[PacketPositions::Base::STATUS_INDEX]) {
         // case UNDEFINED:
         // break;
@@ -305,11 +807,25 @@ void update(uint8_t *buf) {
             break;
         case BUTTON_PUSHED:
             break;
+        case MULTI_MESSAGE:
+            multiMessage(buf);
+            break;
         default:
             Serial.println("Warning: Unknown packet received: " + String(buf[0]));
     }
 }
 
+// several small messages in one report, each handled as if it had come on its own
+void multiMessage(const uint8_t buf[PACKET_SIZE]) {
+    RecMultiMessage recMultiMessage(buf);
+    uint8_t message[PACKET_SIZE];
+    while (recMultiMessage.next(message)) {
+        if (message[PacketPositions::Base::STATUS_INDEX] != MULTI_MESSAGE) {
+            dispatch(message);
+        }
+    }
+}
+
 // triggered when new volume process is opened up on the computer
 void newPID(const uint8_t buf[PACKET_SIZE]) {
     const RecNewPID recNewPID(buf);
@@ -474,56 +990,44 @@ void allCurrentProcesses(const uint8_t buf[PACKET_SIZE]) {
     }
 }
 
-// computer sends info about the icon it is about to send
+// computer sends info about the icon it is about to send, held back if as many are being received as fit
 void iconPacketsInit(const uint8_t buf[PACKET_SIZE]) {
-    if (states.isReceivingIcon()) {
-        Serial.println("Warning: Received icon packet init while already receiving icon");
+    if (!iconTransfers.open(buf)) {
+        Serial.println("Warning: Received icon packet init while all icon transfers are open");
         if (!sendingQueue.push(buf)) {
             uncaughtException("Failed to push icon packet init to queue");
         }
     }
-    const RecIconPacketInit recIconPacketInit(buf);
-    states.setReceivingIcon(true);
-    sentIconPID = recIconPacketInit.getPID();
-    totalIconPackets = recIconPacketInit.getPacketCount();
-    compressionSize = recIconPacketInit.getByteCount();
-    // send ACK in to indicate that we are ready for the first page
-    packetSender.sendAcknowledge(buf[PacketPositions::Base::COUNT_INDEX], ICON_ACK);
 }
 
-// computer sends a page of the icon
+// computer sends a page of an icon, it is decompressed right away so the last one leaves almost nothing to do
 void iconPacket(const uint8_t buf[PACKET_SIZE]) {
-    const RecIconPacket recIconPacket(buf);
-    currentIconPacket++;
-    recIconPacket.emplaceIconData();
-    if (currentIconPacket == totalIconPackets) {
-        uint32_t decompressedSize = fastlz_decompress(compressionBuffer, (int) compressionSize, bufferIcon,
-                                                      ICON_SIZE * ICON_SIZE * sizeof(uint16_t));
-        if (decompressedSize != ICON_SIZE * ICON_SIZE * sizeof(uint16_t)) {
-            Serial.println("Error: Decompression failed");
-            uncaughtException("Decompression failed");
-        } else {
-            for (uint8_t channel = FIRST_CHANNEL; channel < CHANNELS; channel++) {
-                if (faderChannels[channel].appdata.PID == sentIconPID) {
-                    faderChannels[channel].setIcon(bufferIcon, ICON_SIZE, ICON_SIZE);
-                }
-            }
-        }
-        states.setReceivingIcon(false);
+    iconTransfers.packet(buf);
+}
+
+void finishReceivedIcon(const uint32_t pid, const IconHandle icon, const bool decoded) {
+    if (!decoded) {
+        Serial.println("Error: Decompression failed");
+        uncaughtException("Decompression failed");
     }
+    iconCache.store(pid, processName(pid), icon);
+    applyIcon(pid, icon);
+}
+
+void sendIconAck(const uint8_t ackPacket, const uint8_t transfer, const uint16_t received,
+                 const uint8_t freeTransfers) {
+    packetSender.sendIconAcknowledge(ackPacket, transfer, received, freeTransfers);
 }
 
 // default icon
 void iconIsDefault(const uint8_t buf[PACKET_SIZE]) {
     uint32_t iconPID;
     memcpy(&iconPID, buf + PacketPositions::IconIsDefault::PID_INDEX, sizeof(uint32_t));
-    for (uint8_t channel = FIRST_CHANNEL; channel < CHANNELS; channel++) {
-        if (faderChannels[channel].appdata.PID == iconPID) {
-            Serial.println("Setting icon to default for PID: " + String(iconPID));
-            faderChannels[channel].setIcon(defaultIcon, ICON_SIZE, ICON_SIZE);
-        }
-    }
-    states.setReceivingIcon(false);
+    Serial.println("Setting icon to default for PID: " + String(iconPID));
+    const IconHandle icon = iconStore.wrap(defaultIcon);
+    iconCache.store(iconPID, processName(iconPID), icon);
+    applyIcon(iconPID, icon);
+    iconStore.release(icon);
 }
 
 // computer sends info about a process
@@ -554,6 +1058,7 @@ void channelData(const uint8_t buf[PACKET_SIZE]) {
 }
 
 [[noreturn]] void uncaughtException(const String &message) {
+    displayScheduler.waitIdle();
     digitalWrite(CS_LOCK, LOW);
     tft.fillScreen(ST77XX_RED);
     tft.setTextColor(ST77XX_WHITE);
@@ -106,10 +106,19 @@ namespace PacketPositions {
      * Memory layout:
      * [Base Headers][ICON_DATA (PACKET_SIZE - Base Headers)B]
      *
-     * Used to receive chunks of icon data that will be stored in a compression buffer.
+     * Used to receive chunks of icon data, which are decompressed as they arrive.
      * The icon data fills all remaining space in the packet after base headers.
+     * Decompressed, the icon is ICON_SIZE x ICON_SIZE RGB565 pixels in row-major order (API version 2+).
+     * From API version 3 the COUNT header is [SEQUENCE 12 bits][TRANSFER 4 bits]: the packet's index within its
+     * transfer and the transfer ID from IconPacketInit, so packets of several icons can be interleaved.
      */
     struct IconPacket {
+        /// Low bits of COUNT, packet index within the transfer
+        static constexpr uint16_t SEQUENCE_MASK = 0x0FFF;
+
+        /// COUNT is shifted right by this for the transfer ID
+        static constexpr uint8_t TRANSFER_SHIFT = 12;
+
         /// Starting index of icon data bytes
         static constexpr uint8_t ICON_INDEX = Base::NEXT_FREE_INDEX;
 
@@ -122,10 +131,12 @@ namespace PacketPositions {
      * @brief Field positions for IconPacketInit packet (C2F)
      *
      * Memory layout:
-     * [Base Headers][PID 4B][PACKET_COUNT 4B]
+     * [Base Headers][PID 4B][PACKET_COUNT 4B][BYTE_COUNT 4B][CODEC 1B][TRANSFER 1B]
      *
      * Used as the initial packet for icon data transfer.
-     * Contains the process ID and the total number of icon packets that will follow.
+     * Contains the process ID, the total number of icon packets that will follow, the compressed size, the
+     * IconCodec it was compressed with (one of those offered in RequestIcon) and the transfer ID (0-15) its
+     * IconPackets carry. Hosts before API version 3 send one icon at a time and no transfer ID.
      */
     struct IconPacketInit {
         /// Process ID associated with the icon (4 bytes)
@@ -136,6 +147,12 @@ namespace PacketPositions {
 
         /// Total number of bytes (4 bytes)
         static constexpr  uint8_t ICON_BYTE_COUNT_INDEX = ICON_PACKET_COUNT_INDEX + sizeof(uint32_t);
+
+        /// IconCodec of the icon data (1 byte)
+        static constexpr uint8_t ICON_CODEC_INDEX = ICON_BYTE_COUNT_INDEX + sizeof(uint32_t);
+
+        /// Transfer ID of the icon (1 byte)
+        static constexpr uint8_t ICON_TRANSFER_INDEX = ICON_CODEC_INDEX + sizeof(uint8_t);
     };
 
     /**
@@ -194,9 +211,13 @@ namespace PacketPositions {
      * @brief Field positions for Acknowledge packet (C2F and F2C)
      *
      * Memory layout:
-     * [Base Headers][ACK_PACKET 1B]
+     * [Base Headers][ACK_PACKET 1B][ACK_TYPE 1B][TRANSFER 1B][RECEIVED 2B][FREE_TRANSFERS 1B]
      *
      * Used to acknowledge receipt of a specific packet type.
+     * An ICON_ACK (API version 3) is cumulative: RECEIVED is how many IconPackets of the transfer arrived in order,
+     * the host resends from there if that is fewer than it sent. FREE_TRANSFERS is how many more icon transfers
+     * the firmware can take right now. It is sent when a transfer opens, every IconTransfers::ACK_INTERVAL
+     * packets and when the transfer is complete.
      */
     struct AcknowledgePacket {
         /// Packet index being acknowledged (1 byte)
@@ -204,6 +225,14 @@ namespace PacketPositions {
         /// packet tupe being acknowledged (1 byte)
         static constexpr uint8_t ACK_TYPE_INDEX = ACK_PACKET_INDEX + sizeof(uint8_t);
 
+        /// Icon transfer ID (1 byte)
+        static constexpr uint8_t TRANSFER_INDEX = ACK_TYPE_INDEX + sizeof(uint8_t);
+
+        /// IconPackets of the transfer received in order (2 bytes)
+        static constexpr uint8_t RECEIVED_INDEX = TRANSFER_INDEX + sizeof(uint8_t);
+
+        /// Icon transfers the firmware can still open (1 byte)
+        static constexpr uint8_t FREE_TRANSFERS_INDEX = RECEIVED_INDEX + sizeof(uint16_t);
     };
 
     /**
@@ -301,13 +330,17 @@ namespace PacketPositions {
      * @brief Field positions for RequestIcon packet (F2C)
      *
      * Memory layout:
-     * [Base Headers][PID 4B]
+     * [Base Headers][PID 4B][CODECS 1B]
      *
      * Used to request an icon for a specific process.
+     * CODECS has bit n set for every IconCodec n the firmware can decode.
      */
     struct RequestIcon {
         /// Process ID (4 bytes)
         static constexpr uint8_t PID_INDEX = Base::NEXT_FREE_INDEX;
+
+        /// Bit mask of supported IconCodec values (1 byte)
+        static constexpr uint8_t CODECS_INDEX = PID_INDEX + sizeof(uint32_t);
     };
 
     /**
@@ -336,5 +369,27 @@ namespace PacketPositions {
         /// Process ID (4 bytes)
         static constexpr uint8_t PID_INDEX = Base::NEXT_FREE_INDEX;
     };
+
+    /**
+     * @brief Field positions for MultiMessage packet (C2F and F2C, API version 4+)
+     *
+     * Memory layout:
+     * [Base Headers][LENGTH 1B][STATUS 1B][FIELDS (LENGTH - 1)B][LENGTH 1B][STATUS 1B]...[LENGTH 0]
+     *
+     * Used to carry several small messages in one report. Each message is its own packet without the base
+     * headers' VERSION and COUNT, cut after its last field; LENGTH counts the STATUS and field bytes. It unpacks to
+     * a packet with the VERSION and COUNT of the MultiMessage and zeros past its fields. A LENGTH of 0 or the end
+     * of the report ends the list. Messages that use COUNT (ICON_PACKET) are never packed.
+     */
+    struct MultiMessage {
+        /// LENGTH of the first message (1 byte)
+        static constexpr uint8_t FIRST_MESSAGE_INDEX = Base::NEXT_FREE_INDEX;
+
+        /// LENGTH in front of every message's STATUS and fields
+        static constexpr uint8_t LENGTH_SIZE = 1;
+
+        /// Bytes available for messages and their lengths
+        static constexpr uint8_t CAPACITY = PACKET_SIZE - FIRST_MESSAGE_INDEX;
+    };
 }
 
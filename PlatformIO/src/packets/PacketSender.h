@@ -3,7 +3,15 @@
 #include <Arduino.h>
 #include "Globals.h"
 #include "PacketPositions.h"
+#include "RecMultiMessage.h"
 
+/**
+ * @brief Builds and sends the firmware's messages to the computer
+ *
+ * Once the computer has shown it speaks API version 4, small messages are packed into MULTI_MESSAGE reports
+ * (see PacketPositions::MultiMessage) and only go out on flush() or when the report is full, so a burst of
+ * requests takes a few reports instead of one each. A report holding a single message is sent as that message.
+ */
 class PacketSender {
 public:
     PacketSender() = default;
@@ -14,25 +22,56 @@ public:
         counter++;
     }
 
+    /// API version of the last packet from the computer, packing starts at MULTI_MESSAGE_API_VERSION
+    void setComputerVersion(const uint8_t version) {
+        packing = version >= MULTI_MESSAGE_API_VERSION;
+    }
+
+    /// Sends the messages packed so far, called at the end of every loop() pass
+    void flush() {
+        if (reportMessages == 1) {
+            uint8_t message[PACKET_SIZE];
+            RecMultiMessage(report).next(message);
+            send(message);
+        } else if (reportMessages > 1) {
+            send(report);
+        }
+        reportMessages = 0;
+    }
+
     void sendAcknowledge(const uint8_t ackPacket, const AckType type) {
         using Packet = PacketPositions::AcknowledgePacket;
         preparePacket();
         packet[Base::STATUS_INDEX] = ACK;
         packet[Packet::ACK_PACKET_INDEX] = ackPacket;
         packet[Packet::ACK_TYPE_INDEX] = type;
-        sendPacket();
+        sendPacket(Packet::ACK_TYPE_INDEX + sizeof(uint8_t));
+    }
+
+    /// Cumulative ICON_ACK, see PacketPositions::AcknowledgePacket
+    void sendIconAcknowledge(const uint8_t ackPacket, const uint8_t transfer, const uint16_t received,
+                             const uint8_t freeTransfers) {
+        using Packet = PacketPositions::AcknowledgePacket;
+        preparePacket();
+        packet[Base::STATUS_INDEX] = ACK;
+        packet[Packet::ACK_PACKET_INDEX] = ackPacket;
+        packet[Packet::ACK_TYPE_INDEX] = ICON_ACK;
+        packet[Packet::TRANSFER_INDEX] = transfer;
+        memcpy(packet + Packet::RECEIVED_INDEX, &received, sizeof(uint16_t));
+        packet[Packet::FREE_TRANSFERS_INDEX] = freeTransfers;
+        sendPacket(Packet::FREE_TRANSFERS_INDEX + sizeof(uint8_t));
     }
 
     void sendStopNormalBroadcasts() {
         preparePacket();
         packet[Base::STATUS_INDEX] = STOP_NORMAL_BROADCASTS;
-        sendPacket();
+        sendPacket(Base::NEXT_FREE_INDEX);
     }
 
     void sendStartNormalBroadcasts() {
         preparePacket();
         packet[Base::STATUS_INDEX] = START_NORMAL_BROADCASTS;
-        sendPacket();
+        sendPacket(Base::NEXT_FREE_INDEX);
     }
 
     void sendRequestChannelData(const uint32_t PID) {
@@ -40,7 +79,7 @@ public:
         preparePacket();
         packet[Base::STATUS_INDEX] = REQUEST_CHANNEL_DATA;
         memcpy(packet + Packet::PID_INDEX, &PID, sizeof(uint32_t));
-        sendPacket();
+        sendPacket(Packet::PID_INDEX + sizeof(uint32_t));
     }
 
     void sendChannelData(const bool isMaster, const uint8_t maxVolume, const bool isMuted, const uint32_t PID,
@@ -53,7 +92,7 @@ public:
         packet[Packet::IS_MUTED_INDEX] = isMuted;
         memcpy(packet + Packet::PID_INDEX, &PID, sizeof(uint32_t));
         memcpy(packet + Packet::NAME_INDEX, name, NAME_LENGTH_MAX);
-        sendPacket();
+        sendPacket(Packet::NAME_INDEX + NAME_LENGTH_MAX);
     }
 
     void sendCurrentSelectedProcesses(const uint32_t *PIDs, const uint8_t count) {
@@ -66,7 +105,7 @@ public:
         packet[Base::STATUS_INDEX] = CURRENT_SELECTED_PROCESSES;
         memcpy(packet + Packet::COUNT_INDEX, &count, sizeof(uint8_t));
         memcpy(packet + Packet::PIDS_INDEX, PIDs, count * sizeof(uint32_t));
-        sendPacket();
+        sendPacket(Packet::PIDS_INDEX + count * sizeof(uint32_t));
     }
 
     void sendRequestIcon(const uint32_t PID) {
@@ -74,19 +113,26 @@ public:
         preparePacket();
         packet[Base::STATUS_INDEX] = REQUEST_ICON;
         memcpy(packet + Packet::PID_INDEX, &PID, sizeof(uint32_t));
-        sendPacket();
+        packet[Packet::CODECS_INDEX] = SUPPORTED_ICON_CODECS;
+        sendPacket(Packet::CODECS_INDEX + sizeof(uint8_t));
     }
 
     void sendRequestAllProcesses() {
         preparePacket();
         packet[Base::STATUS_INDEX] = REQUEST_ALL_PROCESSES;
-        sendPacket();
+        sendPacket(Base::NEXT_FREE_INDEX);
     }
 
 private:
     using Base = PacketPositions::Base;
+    using Multi = PacketPositions::MultiMessage;
+    static constexpr uint8_t MULTI_MESSAGE_API_VERSION = 4;
     uint8_t counter = 0;
     uint8_t packet[PACKET_SIZE]{};
+    uint8_t report[PACKET_SIZE]{};
+    uint8_t reportLength = 0;
+    uint8_t reportMessages = 0;
+    bool packing = false;
 
     void __attribute__((always_inline)) preparePacket() {
         incrementCounter();
@@ -94,10 +140,34 @@ private:
         packet[Base::COUNT_INDEX] = counter;
     }
 
-    __attribute__((always_inline)) void sendPacket() const {
+    /// length is up to the end of the message's last field, the whole packet goes out if it is not packed
+    void sendPacket(const uint8_t length = PACKET_SIZE) {
+        const uint8_t messageLength = length - Base::STATUS_INDEX;
+        if (!packing || Multi::LENGTH_SIZE + messageLength > Multi::CAPACITY) {
+            flush();
+            send(packet);
+            return;
+        }
+        if (reportMessages > 0 && reportLength + Multi::LENGTH_SIZE + messageLength > PACKET_SIZE) {
+            flush();
+        }
+        if (reportMessages == 0) {
+            memset(report, 0, sizeof(report));
+            report[Base::VERSION_INDEX] = API_VERSION;
+            memcpy(report + Base::COUNT_INDEX, packet + Base::COUNT_INDEX, sizeof(uint16_t));
+            report[Base::STATUS_INDEX] = MULTI_MESSAGE;
+            reportLength = Multi::FIRST_MESSAGE_INDEX;
+        }
+        report[reportLength] = messageLength;
+        memcpy(report + reportLength + Multi::LENGTH_SIZE, packet + Base::STATUS_INDEX, messageLength);
+        reportLength += Multi::LENGTH_SIZE + messageLength;
+        reportMessages++;
+    }
+
+    static void send(const uint8_t buf[PACKET_SIZE]) {
         // 0 is timeout, -1 is usb not available, > 0 is success
-        Serial.println("Sending packet: " + String(packet[Base::STATUS_INDEX]));
-        if (const int32_t result = RawHID.send(packet, 0); result <= 0) {
+        Serial.println("Sending packet: " + String(buf[Base::STATUS_INDEX]));
+        if (const int32_t result = RawHID.send(buf, 0); result <= 0) {
             Serial.println("Failed to send packet: " + String(result));
         }
     }
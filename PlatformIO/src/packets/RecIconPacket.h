@@ -8,9 +8,23 @@ public:
     explicit RecIconPacket(const uint8_t *_data) : BasePacket(_data) {
     }
 
-    __attribute__((always_inline)) void emplaceIconData() const {
-        memcpy(&compressionBuffer[compressionIndex], data + Positions::ICON_INDEX, Positions::NUM_ICON_BYTES_SENT);
-        compressionIndex += Positions::NUM_ICON_BYTES_SENT;
+    /// Index of the packet within its transfer (API version 3+)
+    [[nodiscard]] __attribute__((always_inline)) uint16_t getSequence() const {
+        return getCount() & Positions::SEQUENCE_MASK;
+    }
+
+    /// Transfer ID from IconPacketInit (API version 3+)
+    [[nodiscard]] __attribute__((always_inline)) uint8_t getTransfer() const {
+        return getCount() >> Positions::TRANSFER_SHIFT;
+    }
+
+    /// Compressed icon bytes, the last packet of an icon is padded past the byte count from IconPacketInit
+    [[nodiscard]] __attribute__((always_inline)) const uint8_t *getIconData() const {
+        return data + Positions::ICON_INDEX;
+    }
+
+    [[nodiscard]] static constexpr uint8_t getIconDataLength() {
+        return Positions::NUM_ICON_BYTES_SENT;
     }
 
 private:
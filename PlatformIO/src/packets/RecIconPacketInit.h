@@ -26,6 +26,14 @@ public:
         return value;
     }
 
+    [[nodiscard]] __attribute__((always_inline)) uint8_t getCodec() const {
+        return data[Positions::ICON_CODEC_INDEX];
+    }
+
+    [[nodiscard]] __attribute__((always_inline)) uint8_t getTransfer() const {
+        return data[Positions::ICON_TRANSFER_INDEX];
+    }
+
 private:
     using Positions = PacketPositions::IconPacketInit;
 };
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Arduino.h>
+#include "BasePacket.h"
+
+class RecMultiMessage final : public BasePacket {
+public:
+    explicit RecMultiMessage(const uint8_t *_data) : BasePacket(_data) {
+    }
+
+    /// Unpacks the next message into a whole packet, false after the last one or if its length runs past the report
+    bool next(uint8_t message[PACKET_SIZE]) {
+        if (offset >= PACKET_SIZE) {
+            return false;
+        }
+        const uint8_t length = data[offset];
+        if (length == 0 || offset + Positions::LENGTH_SIZE + length > PACKET_SIZE) {
+            offset = PACKET_SIZE;
+            return false;
+        }
+        memset(message, 0, PACKET_SIZE);
+        memcpy(message, data, Base::STATUS_INDEX); // VERSION and COUNT
+        memcpy(message + Base::STATUS_INDEX, data + offset + Positions::LENGTH_SIZE, length);
+        offset += Positions::LENGTH_SIZE + length;
+        return true;
+    }
+
+private:
+    using Base = PacketPositions::Base;
+    using Positions = PacketPositions::MultiMessage;
+    uint8_t offset = Positions::FIRST_MESSAGE_INDEX;
+};
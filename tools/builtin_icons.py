@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""Generate PlatformIO/src/icons.h, the built-in icons compressed with IconRLE (see PlatformIO/src/IconRLE.h).
+
+Usage:
+    builtin_icons.py <icons.h> <name>=<icon.png>...
+
+e.g. builtin_icons.py PlatformIO/src/icons.h defaultIcon=PlatformIO/icons/default.png
+
+Each icon is converted like tools/icon_corpus.py does (scaled to 128x128, composited onto black) and stored as a
+PROGMEM byte array plus a BuiltinIcon named <name>. The firmware draws them from flash a few rows at a time, so
+only the compressed bytes take up space.
+"""
+
+import os
+import struct
+import sys
+
+from icon_corpus import ICON_SIZE, read_png, to_icon
+
+PIXELS = ICON_SIZE * ICON_SIZE
+MAX_PALETTE = 255
+OP_RUN, OP_ABOVE, OP_PALETTE, OP_RAW = range(4)
+BYTES_PER_LINE = 16
+
+
+def previous(pixels, index):
+    return pixels[index - 1] if index > 0 else 0
+
+
+def run_length(pixels, index):
+    colour = previous(pixels, index)
+    length = 0
+    while index + length < PIXELS and pixels[index + length] == colour:
+        length += 1
+    return length
+
+
+def above_length(pixels, index):
+    if index < ICON_SIZE:
+        return 0
+    length = 0
+    while index + length < PIXELS and pixels[index + length] == pixels[index + length - ICON_SIZE]:
+        length += 1
+    return length
+
+
+def build_palette(pixels):
+    """Colours of at least 3 pixels that neither a run nor the row above covers, most used first."""
+    counts = {}
+    for i, colour in enumerate(pixels):
+        if colour != previous(pixels, i) and (i < ICON_SIZE or colour != pixels[i - ICON_SIZE]):
+            counts[colour] = counts.get(colour, 0) + 1
+    used = sorted(counts, key=lambda colour: (-counts[colour], colour))
+    return sorted(colour for colour in used[:MAX_PALETTE] if counts[colour] >= 3)
+
+
+def token(op, length):
+    if length < 64:
+        return bytes([op << 6 | (length - 1)])
+    out = bytearray([op << 6 | 63])
+    extra = length - 64
+    while True:
+        out.append((extra & 127) | (128 if extra >= 128 else 0))
+        extra >>= 7
+        if extra == 0:
+            return bytes(out)
+
+
+def compress(pixels):
+    """Same choices as IconRLE::compress()."""
+    palette = build_palette(pixels)
+    index = {colour: i for i, colour in enumerate(palette)}
+    out = bytearray([len(palette)])
+    for colour in palette:
+        out += struct.pack("<H", colour)
+    i = 0
+    while i < PIXELS:
+        run = run_length(pixels, i)
+        above = above_length(pixels, i)
+        if run >= 2 or above >= 2:
+            length = run if run >= above else above
+            out += token(OP_RUN if run >= above else OP_ABOVE, length)
+            i += length
+            continue
+        in_palette = pixels[i] in index
+        end = i + 1
+        while (end < PIXELS and run_length(pixels, end) < 2 and above_length(pixels, end) < 2
+               and (pixels[end] in index) == in_palette):
+            end += 1
+        out += token(OP_PALETTE if in_palette else OP_RAW, end - i)
+        for colour in pixels[i:end]:
+            out += bytes([index[colour]]) if in_palette else struct.pack("<H", colour)
+        i = end
+    return bytes(out)
+
+
+def array(name, data):
+    lines = [f"static constexpr uint8_t {name}[] PROGMEM = {{"]
+    for offset in range(0, len(data), BYTES_PER_LINE):
+        lines.append("    " + ", ".join(f"0x{value:02X}" for value in data[offset:offset + BYTES_PER_LINE]) + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    if len(sys.argv) < 3 or any("=" not in argument for argument in sys.argv[2:]):
+        print(__doc__)
+        sys.exit(1)
+    parts = [
+        "#pragma once",
+        "",
+        "// Generated by tools/builtin_icons.py, do not edit",
+        "",
+        "#include <Arduino.h>",
+        '#include "IconStore.h"',
+    ]
+    for argument in sys.argv[2:]:
+        name, path = argument.split("=", 1)
+        icon = to_icon(*read_png(path))
+        pixels = list(struct.unpack(f"<{PIXELS}H", icon))
+        data = compress(pixels)
+        parts += [
+            "",
+            f"// {os.path.basename(path)}, {len(data)} bytes instead of {len(icon)}",
+            array(name + "RLE", data),
+            f"static constexpr BuiltinIcon {name}{{{name}RLE, sizeof({name}RLE)}};",
+        ]
+        print(f"{path} -> {name}, {len(data)} bytes")
+    with open(sys.argv[1], "w") as file:
+        file.write("\n".join(parts) + "\n")
+
+
+if __name__ == "__main__":
+    main()
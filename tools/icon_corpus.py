@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""Convert PNG icons into the raw icons the icon codec benchmark reads (see PlatformIO/lib/CodecBench).
+
+Usage:
+    icon_corpus.py <output dir> <icon.png>...
+
+Every icon is scaled to 128x128, composited onto black like the computer does before sending it, and written as
+<name>.rgb565: 128 * 128 little endian RGB565 pixels in row-major order. Only the standard library is used, so
+non-interlaced PNGs of any colour type at 8 bits per channel (or palette/grey at 1, 2, 4 or 8 bits) are read.
+"""
+
+import os
+import struct
+import sys
+import zlib
+
+ICON_SIZE = 128
+PNG_SIGNATURE = b"\x89PNG\r\n\x1a\n"
+CHANNELS = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def unfilter(raw, height, stride, bpp):
+    rows = []
+    previous = bytearray(stride)
+    offset = 0
+    for _ in range(height):
+        kind = raw[offset]
+        row = bytearray(raw[offset + 1:offset + 1 + stride])
+        offset += 1 + stride
+        for i in range(stride):
+            left = row[i - bpp] if i >= bpp else 0
+            up = previous[i]
+            corner = previous[i - bpp] if i >= bpp else 0
+            if kind == 1:
+                row[i] = (row[i] + left) & 0xFF
+            elif kind == 2:
+                row[i] = (row[i] + up) & 0xFF
+            elif kind == 3:
+                row[i] = (row[i] + ((left + up) >> 1)) & 0xFF
+            elif kind == 4:
+                row[i] = (row[i] + paeth(left, up, corner)) & 0xFF
+        rows.append(row)
+        previous = row
+    return rows
+
+
+def read_png(path):
+    """Returns (width, height, rows of (r, g, b, a) tuples)."""
+    with open(path, "rb") as file:
+        data = file.read()
+    if not data.startswith(PNG_SIGNATURE):
+        raise ValueError("not a PNG")
+    offset = len(PNG_SIGNATURE)
+    idat = b""
+    palette = []
+    transparency = b""
+    while offset < len(data):
+        length, kind = struct.unpack(">I4s", data[offset:offset + 8])
+        body = data[offset + 8:offset + 8 + length]
+        offset += 12 + length
+        if kind == b"IHDR":
+            width, height, depth, colour, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            palette = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b"tRNS":
+            transparency = body
+        elif kind == b"IDAT":
+            idat += body
+        elif kind == b"IEND":
+            break
+    if interlace:
+        raise ValueError("interlaced PNGs are not supported")
+    if depth != 8 and colour not in (0, 3):
+        raise ValueError("only 8 bits per channel are supported")
+    channels = CHANNELS[colour]
+    bits = depth * channels
+    stride = (width * bits + 7) // 8
+    rows = unfilter(zlib.decompress(idat), height, stride, max(1, bits // 8))
+
+    pixels = []
+    for row in rows:
+        if depth < 8:
+            mask = (1 << depth) - 1
+            samples = [(row[i * depth // 8] >> (8 - depth - (i * depth) % 8)) & mask for i in range(width)]
+        else:
+            samples = None
+        line = []
+        for x in range(width):
+            if colour == 3:
+                index = samples[x] if samples is not None else row[x]
+                r, g, b = palette[index]
+                a = transparency[index] if index < len(transparency) else 255
+            elif colour == 0:
+                value = samples[x] * 255 // ((1 << depth) - 1) if samples is not None else row[x]
+                r = g = b = value
+                a = 255
+            elif colour == 4:
+                r = g = b = row[2 * x]
+                a = row[2 * x + 1]
+            elif colour == 2:
+                r, g, b = row[3 * x:3 * x + 3]
+                a = 255
+            else:
+                r, g, b, a = row[4 * x:4 * x + 4]
+            line.append((r, g, b, a))
+        pixels.append(line)
+    return width, height, pixels
+
+
+def to_icon(width, height, pixels):
+    """Area average (or nearest when enlarging) to ICON_SIZE, alpha composited onto black, as RGB565 bytes."""
+    out = bytearray()
+    for y in range(ICON_SIZE):
+        y0, y1 = y * height // ICON_SIZE, max(y * height // ICON_SIZE + 1, (y + 1) * height // ICON_SIZE)
+        for x in range(ICON_SIZE):
+            x0, x1 = x * width // ICON_SIZE, max(x * width // ICON_SIZE + 1, (x + 1) * width // ICON_SIZE)
+            r = g = b = 0
+            for sy in range(y0, y1):
+                for sx in range(x0, x1):
+                    pr, pg, pb, pa = pixels[sy][sx]
+                    r += pr * pa
+                    g += pg * pa
+                    b += pb * pa
+            area = (y1 - y0) * (x1 - x0) * 255
+            r, g, b = r // area, g // area, b // area
+            out += struct.pack("<H", (r >> 3) << 11 | (g >> 2) << 5 | (b >> 3))
+    return bytes(out)
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        sys.exit(1)
+    directory = sys.argv[1]
+    os.makedirs(directory, exist_ok=True)
+    for path in sys.argv[2:]:
+        try:
+            icon = to_icon(*read_png(path))
+        except (ValueError, KeyError, zlib.error) as error:
+            print(f"{path}: {error}", file=sys.stderr)
+            continue
+        name = os.path.splitext(os.path.basename(path))[0] + ".rgb565"
+        with open(os.path.join(directory, name), "wb") as file:
+            file.write(icon)
+        print(f"{path} -> {name}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""Decode a profiler dump from the FaderBoard firmware (see PlatformIO/src/Profiler.h).
+
+Usage:
+    profile_decode.py /dev/ttyACM0     send 'p' to the board and decode the reply
+    profile_decode.py capture.bin      decode a saved capture
+    profile_decode.py < capture.bin
+
+The dump may be surrounded by the firmware's normal text output, the decoder looks for the magic bytes.
+"""
+
+import os
+import struct
+import sys
+import termios
+import time
+import tty
+import zlib
+
+MAGIC = struct.pack("<I", 0x52504246)
+VERSION = 1
+
+
+class Truncated(Exception):
+    pass
+
+
+class Reader:
+    def __init__(self, data, offset):
+        self.data = data
+        self.offset = offset
+
+    def take(self, fmt):
+        size = struct.calcsize(fmt)
+        if self.offset + size > len(self.data):
+            raise Truncated()
+        values = struct.unpack_from(fmt, self.data, self.offset)
+        self.offset += size
+        return values if len(values) > 1 else values[0]
+
+    def bytes(self, length):
+        if self.offset + length > len(self.data):
+            raise Truncated()
+        chunk = self.data[self.offset:self.offset + length]
+        self.offset += length
+        return chunk
+
+
+def parse(data):
+    start = data.find(MAGIC)
+    if start < 0:
+        raise Truncated()
+    reader = Reader(data, start + len(MAGIC))
+    version, scope_count, buckets, _ = reader.take("<4B")
+    if version != VERSION:
+        raise ValueError(f"unsupported dump version {version}")
+    cpu_hz = reader.take("<I")
+    scopes = []
+    for _ in range(scope_count):
+        name = reader.bytes(reader.take("<B")).decode("ascii", "replace")
+        count, min_cycles, max_cycles, total_cycles, mask = reader.take("<IIIQI")
+        histogram = [0] * buckets
+        for bucket in range(buckets):
+            if mask & (1 << bucket):
+                histogram[bucket] = reader.take("<I")
+        scopes.append((name, count, min_cycles, max_cycles, total_cycles, histogram))
+    crc = reader.take("<I")
+    if crc != zlib.crc32(data[start:reader.offset - 4]):
+        raise ValueError("checksum mismatch, dump is corrupted")
+    return cpu_hz, scopes
+
+
+def micros(cycles, cpu_hz):
+    return cycles * 1e6 / cpu_hz
+
+
+def print_report(cpu_hz, scopes):
+    print(f"CPU {cpu_hz / 1e6:.0f} MHz")
+    print(f"{'scope':<18}{'count':>10}{'min us':>11}{'mean us':>11}{'max us':>11}")
+    for name, count, min_cycles, max_cycles, total_cycles, _ in scopes:
+        if count == 0:
+            print(f"{name:<18}{0:>10}{'-':>11}{'-':>11}{'-':>11}")
+            continue
+        print(f"{name:<18}{count:>10}{micros(min_cycles, cpu_hz):>11.2f}"
+              f"{micros(total_cycles / count, cpu_hz):>11.2f}{micros(max_cycles, cpu_hz):>11.2f}")
+    for name, count, _, _, _, histogram in scopes:
+        if count == 0:
+            continue
+        print(f"\n{name}")
+        peak = max(histogram)
+        for bucket, hits in enumerate(histogram):
+            if hits == 0:
+                continue
+            low = micros(1 << bucket if bucket else 0, cpu_hz)
+            high = micros(1 << (bucket + 1), cpu_hz)
+            bar = "#" * max(1, round(40 * hits / peak))
+            print(f"  {low:>10.3f} - {high:<10.3f} us {hits:>10} {bar}")
+
+
+def read_device(path, timeout=2.0):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    previous = termios.tcgetattr(fd)
+    try:
+        tty.setraw(fd)
+        termios.tcflush(fd, termios.TCIFLUSH)
+        os.write(fd, b"p")
+        data = b""
+        deadline = time.monotonic() + timeout
+        os.set_blocking(fd, False)
+        while time.monotonic() < deadline:
+            try:
+                chunk = os.read(fd, 4096)
+            except BlockingIOError:
+                chunk = b""
+            if chunk:
+                data += chunk
+                try:
+                    return parse(data)
+                except Truncated:
+                    pass
+            else:
+                time.sleep(0.01)
+        raise Truncated()
+    finally:
+        termios.tcsetattr(fd, termios.TCSADRAIN, previous)
+        os.close(fd)
+
+
+def is_device(path):
+    try:
+        fd = os.open(path, os.O_RDONLY | os.O_NOCTTY | os.O_NONBLOCK)
+    except OSError:
+        return False
+    try:
+        return os.isatty(fd)
+    finally:
+        os.close(fd)
+
+
+def main():
+    try:
+        if len(sys.argv) < 2:
+            result = parse(sys.stdin.buffer.read())
+        elif is_device(sys.argv[1]):
+            result = read_device(sys.argv[1])
+        else:
+            with open(sys.argv[1], "rb") as capture:
+                result = parse(capture.read())
+    except Truncated:
+        sys.exit("no complete profiler dump found")
+    except ValueError as error:
+        sys.exit(str(error))
+    print_report(*result)
+
+
+if __name__ == "__main__":
+    main()